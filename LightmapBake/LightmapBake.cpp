@@ -0,0 +1,51 @@
+/** @file LightmapBake.cpp
+ *
+ *  Bakes the maze's lightmap without a window or a GL context, and writes the .hdr the game loads.
+ *  Builds the static scene on the CPU exactly as the game batches it, so the atlas matches the game's
+ *  lightmap uvs. Run it from the game's directory, or pass the file to write.
+ */
+#include <chrono>
+#include <iostream>
+
+#include "LightmapBaker.h"
+#include "Maze.h"
+#include "MeshRegistry.h"
+#include "StaticBatch.h"
+
+using namespace std;
+
+int main(int argc, char** argv)
+{
+	const char* fileName = argc > 1 ? argv[1] : LIGHTMAP_FILE;
+	MeshRegistry::SetBuffering(false);
+
+	Grid grid(MAZE_GRID_SIZE, 1);
+	grid.Prepare();
+	MazeShape hedges, wall, roof, door, stair, middleRoom;
+	MazeGroups groups = { grid, hedges, wall, roof, door, stair, middleRoom };
+	addMazeShapes(groups);
+	// Only which groups share a batch matters for the atlas, not how the materials look.
+	Material dirt = {}, hedge = {}, stone = {}, roofTiles = {}, wood = {}, stoneFloor = {};
+	MazeMaterials materials = { &dirt, &hedge, &stone, &roofTiles, &wood, &stoneFloor };
+	StaticBatch scene;
+	addMazeToBatch(scene, groups, materials);
+
+	LightmapBaker baker(LIGHTMAP_SIZE);
+	if (!scene.unwrapLightmap(baker))
+	{
+		cerr << "The maze doesn't fit a " << LIGHTMAP_SIZE << " lightmap." << endl;
+		return 1;
+	}
+	auto start = chrono::steady_clock::now();
+	baker.bake(mazeAmbientLight(), mazePointLights(), mazeSpotLights());
+	auto end = chrono::steady_clock::now();
+	cout << "Baked " << baker.chartCount() << " lightmap charts at " << baker.texelsPerUnit() << " texels per unit in "
+		<< chrono::duration<double, milli>(end - start).count() << " ms." << endl;
+	if (!baker.write(fileName))
+	{
+		cerr << "Unable to write " << fileName << endl;
+		return 1;
+	}
+	cout << "Wrote " << fileName << endl;
+	return 0;
+}
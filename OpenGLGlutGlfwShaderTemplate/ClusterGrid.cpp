@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "ClusterGrid.h"
+#include "LightAssignment.h"
+#include "Shape.h"
+
+ClusterGrid::ClusterGrid(int tilesX, int tilesY, int slices)
+	: m_tilesX(tilesX), m_tilesY(tilesY), m_slices(slices)
+{
+}
+
+void ClusterGrid::create()
+{
+	m_paramsBuffer = GLBuffer::create();
+	m_rangesBuffer = GLBuffer::create();
+	m_indicesBuffer = GLBuffer::create();
+	Shape::BufferCount() += 3;
+	m_paramsDirty = true;
+	m_built = false;
+}
+
+void ClusterGrid::release()
+{
+	m_paramsBuffer.reset();
+	m_rangesBuffer.reset();
+	m_indicesBuffer.reset();
+}
+
+void ClusterGrid::setProjection(float fovY, float aspect, float zNear, float zFar)
+{
+	m_scaleY = 1.0f / tanf(fovY * 0.5f);
+	m_scaleX = m_scaleY / aspect;
+	m_near = zNear;
+	m_far = zFar;
+	m_paramsDirty = true;
+}
+
+void ClusterGrid::setViewport(int width, int height)
+{
+	if (width == m_width && height == m_height)
+		return;
+	m_width = std::max(width, 1);
+	m_height = std::max(height, 1);
+	m_paramsDirty = true;
+}
+
+int ClusterGrid::sliceOf(float depth) const
+{
+	int slice = (int)floorf(logf(depth / m_near) / logf(m_far / m_near) * m_slices);
+	return std::min(std::max(slice, 0), m_slices - 1);
+}
+
+float ClusterGrid::sliceDepth(int slice) const
+{
+	return m_near * powf(m_far / m_near, (float)slice / m_slices);
+}
+
+void ClusterGrid::addLight(GLuint light, const glm::mat4& view, glm::vec3 position, float range)
+{
+	glm::vec4 center = view * glm::vec4(position, 1.0f);
+	float depth = -center.z;
+	if (depth + range < m_near || depth - range > m_far)
+		return;
+
+	int firstSlice = sliceOf(std::max(depth - range, m_near));
+	int lastSlice = sliceOf(std::min(depth + range, m_far));
+	for (int slice = firstSlice; slice <= lastSlice; slice++)
+	{
+		// The part of the sphere inside this slice fits in a box whose half width is the widest cross-section in the slice.
+		float sliceNear = std::max(sliceDepth(slice), depth - range);
+		float sliceFar = std::min(sliceDepth(slice + 1), depth + range);
+		float dz = depth < sliceNear ? sliceNear - depth : (depth > sliceFar ? depth - sliceFar : 0.0f);
+		float radius = sqrtf(std::max(range * range - dz * dz, 0.0f));
+
+		// x / depth is monotonic over the box, so its extremes are at the corners.
+		float xs[4] = { (center.x - radius) / sliceNear, (center.x - radius) / sliceFar, (center.x + radius) / sliceNear, (center.x + radius) / sliceFar };
+		float ys[4] = { (center.y - radius) / sliceNear, (center.y - radius) / sliceFar, (center.y + radius) / sliceNear, (center.y + radius) / sliceFar };
+		float minX = *std::min_element(xs, xs + 4) * m_scaleX, maxX = *std::max_element(xs, xs + 4) * m_scaleX;
+		float minY = *std::min_element(ys, ys + 4) * m_scaleY, maxY = *std::max_element(ys, ys + 4) * m_scaleY;
+		if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f)
+			continue;
+
+		LightCells cells;
+		cells.light = light;
+		cells.slice = slice;
+		cells.x0 = std::max((int)floorf((minX * 0.5f + 0.5f) * m_tilesX), 0);
+		cells.x1 = std::min((int)floorf((maxX * 0.5f + 0.5f) * m_tilesX), m_tilesX - 1);
+		cells.y0 = std::max((int)floorf((minY * 0.5f + 0.5f) * m_tilesY), 0);
+		cells.y1 = std::min((int)floorf((maxY * 0.5f + 0.5f) * m_tilesY), m_tilesY - 1);
+		m_cells.push_back(cells);
+	}
+}
+
+void ClusterGrid::build(const glm::mat4& view, const std::vector<PointLight>& points, const std::vector<SpotLight>& spots)
+{
+	m_cells.clear();
+	for (GLuint i = 0; i < points.size(); i++)
+	{
+		if (points[i].diffuseStrength > 0.0f)
+			addLight(i, view, points[i].position, points[i].range);
+	}
+	// A spot light only reaches its cone, so it is binned by the much smaller sphere around that.
+	for (GLuint i = 0; i < spots.size(); i++)
+	{
+		if (spots[i].diffuseStrength <= 0.0f)
+			continue;
+		BoundingSphere bounds = SpotBounds(spots[i]);
+		addLight((GLuint)points.size() + i, view, bounds.center, bounds.radius);
+	}
+
+	// Count, prefix sum, then scatter, so every cluster's lights end up contiguous.
+	m_ranges.assign(clusterCount() * 2, 0);
+	for (const LightCells& cells : m_cells)
+	{
+		for (int y = cells.y0; y <= cells.y1; y++)
+		{
+			for (int x = cells.x0; x <= cells.x1; x++)
+				m_ranges[(x + m_tilesX * (y + m_tilesY * cells.slice)) * 2 + 1]++;
+		}
+	}
+	GLuint offset = 0;
+	for (int cluster = 0; cluster < clusterCount(); cluster++)
+	{
+		m_ranges[cluster * 2] = offset;
+		offset += m_ranges[cluster * 2 + 1];
+		m_ranges[cluster * 2 + 1] = 0;
+	}
+	m_indices.resize(offset);
+	for (const LightCells& cells : m_cells)
+	{
+		for (int y = cells.y0; y <= cells.y1; y++)
+		{
+			for (int x = cells.x0; x <= cells.x1; x++)
+			{
+				GLuint* range = &m_ranges[(x + m_tilesX * (y + m_tilesY * cells.slice)) * 2];
+				m_indices[range[0] + range[1]++] = cells.light;
+			}
+		}
+	}
+}
+
+void ClusterGrid::uploadParams()
+{
+	GpuClusterParams params = {};
+	params.tilesX = m_tilesX;
+	params.tilesY = m_tilesY;
+	params.slices = m_slices;
+	params.tileScaleX = (float)m_tilesX / m_width;
+	params.tileScaleY = (float)m_tilesY / m_height;
+	params.sliceScale = m_slices / logf(m_far / m_near);
+	params.sliceBias = -m_slices * logf(m_near) / logf(m_far / m_near);
+	GLState::BindBuffer(GL_UNIFORM_BUFFER, m_paramsBuffer.get());
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(params), &params, GL_STATIC_DRAW);
+	GLState::BindBuffer(GL_UNIFORM_BUFFER, 0);
+	GLState::BindBufferBase(GL_UNIFORM_BUFFER, CLUSTER_PARAMS_BINDING, m_paramsBuffer.get());
+	Shape::UploadedBytes() += sizeof(params);
+	m_paramsDirty = false;
+}
+
+void ClusterGrid::update(FrameRing& ring, const glm::mat4& view, const std::vector<PointLight>& points, const std::vector<SpotLight>& spots, unsigned lightVersion)
+{
+	if (!m_paramsBuffer)
+		return;
+	bool paramsChanged = m_paramsDirty;
+	if (m_paramsDirty)
+		uploadParams();
+	if (m_built && !paramsChanged && view == m_view && lightVersion == m_lightVersion)
+	{
+		// The ring region holding the lists gets reused a few frames from now, so unchanged lists move to
+		// buffers of their own once, and stay there until the next rebuild.
+		if (m_listsInRing)
+			uploadLists();
+		return;
+	}
+	m_view = view;
+	m_lightVersion = lightVersion;
+	m_built = true;
+	build(view, points, spots);
+
+	// Rebuilt lists go into this frame's ring region, so a moving camera never waits on a buffer the GPU reads.
+	// The index list is never empty, so the binding stays valid when no light is in view.
+	GLsizeiptr rangeBytes = m_ranges.size() * sizeof(GLuint);
+	GLsizeiptr indexBytes = std::max<size_t>(m_indices.size(), 1) * sizeof(GLuint);
+	FrameRing::Allocation ranges = ring.allocateStorage(rangeBytes);
+	FrameRing::Allocation indices = ring.allocateStorage(indexBytes);
+	if (ranges.data == nullptr || indices.data == nullptr)
+	{
+		uploadLists();
+		return;
+	}
+	memcpy(ranges.data, m_ranges.data(), rangeBytes);
+	GLuint none = 0;
+	memcpy(indices.data, m_indices.empty() ? &none : m_indices.data(), indexBytes);
+	ring.bindStorage(CLUSTER_RANGES_BINDING, ranges);
+	ring.bindStorage(CLUSTER_LIGHTS_BINDING, indices);
+	Shape::UploadedBytes() += rangeBytes + indexBytes;
+	m_listsInRing = true;
+}
+
+void ClusterGrid::uploadLists()
+{
+	// Sizes change with the camera, so both lists are re-specified rather than patched.
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, m_rangesBuffer.get());
+	glBufferData(GL_SHADER_STORAGE_BUFFER, m_ranges.size() * sizeof(GLuint), m_ranges.data(), GL_STREAM_DRAW);
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, m_indicesBuffer.get());
+	// Never empty, so the binding stays valid when no light is in view.
+	GLuint none = 0;
+	if (m_indices.empty())
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), &none, GL_STREAM_DRAW);
+	else
+		glBufferData(GL_SHADER_STORAGE_BUFFER, m_indices.size() * sizeof(GLuint), m_indices.data(), GL_STREAM_DRAW);
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_RANGES_BINDING, m_rangesBuffer.get());
+	GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, CLUSTER_LIGHTS_BINDING, m_indicesBuffer.get());
+	Shape::UploadedBytes() += (m_ranges.size() + m_indices.size()) * sizeof(GLuint);
+	m_listsInRing = false;
+}
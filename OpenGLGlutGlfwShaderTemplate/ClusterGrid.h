@@ -0,0 +1,91 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "FrameRing.h"
+#include "GLHandle.h"
+#include "Light.h"
+
+// Uniform block binding of ClusterParams, and storage bindings of ClusterRanges and ClusterLights, in lighting.glsl.
+#define CLUSTER_PARAMS_BINDING 1
+#define CLUSTER_RANGES_BINDING 1
+#define CLUSTER_LIGHTS_BINDING 2
+
+// std140 mirror of the ClusterParams block.
+struct GpuClusterParams
+{
+	GLuint tilesX, tilesY, slices, pad;
+	// Tiles per pixel in x and y, then the scale and bias that turn log(view depth) into a slice.
+	GLfloat tileScaleX, tileScaleY, sliceScale, sliceBias;
+};
+
+static_assert(sizeof(GpuClusterParams) == 32, "GpuClusterParams does not match std140");
+
+// Splits the view frustum into screen tiles times exponential depth slices, and lists the point and spot lights
+// whose range reaches into each cluster. The fragment shader then only loops over its own cluster's lights.
+// Spot lights are listed after the point lights, as points.size() + their index.
+class ClusterGrid
+{
+public:
+	ClusterGrid(int tilesX = 16, int tilesY = 16, int slices = 24);
+
+	void create();
+	void release();
+	// Must match the projection matrix the scene is drawn with.
+	void setProjection(float fovY, float aspect, float zNear, float zFar);
+	void setViewport(int width, int height);
+
+	// Rebuilds the light lists if the view, the lights or the grid changed since the last call, and writes them
+	// into this frame's part of ring. Unchanged lists are left in buffers of their own. Call between
+	// ring.beginFrame and ring.flush.
+	void update(FrameRing& ring, const glm::mat4& view, const std::vector<PointLight>& points, const std::vector<SpotLight>& spots, unsigned lightVersion);
+	// The CPU part of update: fills the per-cluster ranges and the light index list. Needs no GL.
+	void build(const glm::mat4& view, const std::vector<PointLight>& points, const std::vector<SpotLight>& spots);
+
+	int clusterCount() const { return m_tilesX * m_tilesY * m_slices; }
+	// Light indices over all clusters from the last build.
+	size_t indexCount() const { return m_indices.size(); }
+	// Offset into the index list, then light count, for every cluster.
+	const std::vector<GLuint>& ranges() const { return m_ranges; }
+	const std::vector<GLuint>& indices() const { return m_indices; }
+
+private:
+	struct LightCells
+	{
+		GLuint light;
+		int slice, x0, x1, y0, y1;
+	};
+
+	// Records the clusters a light's bounding sphere touches.
+	void addLight(GLuint light, const glm::mat4& view, glm::vec3 position, float range);
+	int sliceOf(float depth) const;
+	float sliceDepth(int slice) const;
+	void uploadParams();
+	// Sends the lists to buffers of their own and binds those instead: once they stop changing, and on frames
+	// the ring has no room in.
+	void uploadLists();
+
+	int m_tilesX, m_tilesY, m_slices;
+	float m_near = 0.1f, m_far = 100.0f;
+	// Projection scale in x and y.
+	float m_scaleX = 1.0f, m_scaleY = 1.0f;
+	int m_width = 1, m_height = 1;
+	bool m_paramsDirty = true;
+
+	glm::mat4 m_view;
+	unsigned m_lightVersion = 0;
+	bool m_built = false;
+	// The lists are bound from a ring region rather than m_rangesBuffer and m_indicesBuffer.
+	bool m_listsInRing = false;
+
+	std::vector<GLuint> m_ranges;
+	std::vector<GLuint> m_indices;
+	std::vector<LightCells> m_cells;
+
+	GLBuffer m_paramsBuffer;
+	GLBuffer m_rangesBuffer;
+	GLBuffer m_indicesBuffer;
+
+};
@@ -0,0 +1,27 @@
+#include "CommandList.h"
+
+#include <cstring>
+
+void CommandList::upload(GLBuffer* buffer, GLenum target, GLintptr offset, const void* data, GLsizeiptr size, bool replace)
+{
+	size_t start = m_bytes.size();
+	m_bytes.resize(start + size);
+	if (size > 0)
+		memcpy(&m_bytes[start], data, size);
+	m_commands.push_back({ COMMAND_UPLOAD, m_uploads.size() });
+	m_uploads.push_back({ buffer, target, offset, size, start, replace });
+}
+
+void CommandList::draw(const DrawItem& item, const GLBuffer* instanceBuffer)
+{
+	m_commands.push_back({ COMMAND_DRAW, m_draws.size() });
+	m_draws.push_back({ item, instanceBuffer });
+}
+
+void CommandList::clear()
+{
+	m_commands.clear();
+	m_uploads.clear();
+	m_draws.clear();
+	m_bytes.clear();
+}
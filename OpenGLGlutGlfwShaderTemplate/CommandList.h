@@ -0,0 +1,66 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <vector>
+
+#include "DrawQueue.h"
+#include "GLHandle.h"
+
+// A frame's draws and buffer writes for one part of the scene, recorded away from the GL thread and replayed
+// on it later. Recording only copies into CPU memory and makes no GL calls, so each worker can fill a list of
+// its own while the GL thread stays the only one talking to GL. Draws refer to meshes, materials and matrices
+// rather than GL state, and replay hands them to a DrawQueue, whose sorted flush does the binds.
+class CommandList
+{
+public:
+	// Writes size bytes of data into buffer at offset, copied now. replace makes it a glBufferData of the whole
+	// buffer instead, which also creates buffer's GL object if it has none yet.
+	void upload(GLBuffer* buffer, GLenum target, GLintptr offset, const void* data, GLsizeiptr size, bool replace);
+	// Queues item once for every pass the list is replayed into. Pointers in item must stay valid until the
+	// queue is flushed. instanceBuffer, unless nullptr, stands in for item.instanceBuffer, since its GL object
+	// may only be created by an upload during replay.
+	void draw(const DrawItem& item, const GLBuffer* instanceBuffer = nullptr);
+
+	// Runs the uploads and submits the draws to every one of passes, in the order they were recorded.
+	// GL thread only. The list keeps its commands until clear. Lives in CommandListReplay.cpp, so code that only
+	// records, like the tests, doesn't need DrawQueue or a context.
+	void replay(DrawQueue& queue, const std::vector<unsigned>& passes) const;
+	// Keeps the memory, so a list recorded every frame stops allocating after the first few.
+	void clear();
+
+	size_t drawCount() const { return m_draws.size(); }
+	// The index-th recorded draw. Its instanceBuffer is only filled in by replay.
+	const DrawItem& drawItem(size_t index) const { return m_draws[index].item; }
+	size_t uploadBytes() const { return m_bytes.size(); }
+
+private:
+	enum CommandType { COMMAND_UPLOAD, COMMAND_DRAW };
+
+	struct Command
+	{
+		CommandType type;
+		size_t index; // Into m_uploads or m_draws.
+	};
+
+	struct Upload
+	{
+		GLBuffer* buffer;
+		GLenum target;
+		GLintptr offset;
+		GLsizeiptr size;
+		size_t data; // Into m_bytes.
+		bool replace;
+	};
+
+	struct Draw
+	{
+		DrawItem item;
+		const GLBuffer* instanceBuffer;
+	};
+
+	std::vector<Command> m_commands;
+	std::vector<Upload> m_uploads;
+	std::vector<Draw> m_draws;
+	std::vector<char> m_bytes;
+
+};
@@ -0,0 +1,32 @@
+#include "CommandList.h"
+
+void CommandList::replay(DrawQueue& queue, const std::vector<unsigned>& passes) const
+{
+	for (const Command& command : m_commands)
+	{
+		if (command.type == COMMAND_UPLOAD)
+		{
+			const Upload& upload = m_uploads[command.index];
+			const void* data = upload.size > 0 ? &m_bytes[upload.data] : nullptr;
+			if (upload.replace && !*upload.buffer)
+			{
+				*upload.buffer = GLBuffer::create();
+				Shape::BufferCount()++;
+			}
+			GLState::BindBuffer(upload.target, upload.buffer->get());
+			if (upload.replace)
+				glBufferData(upload.target, upload.size, data, GL_STATIC_DRAW);
+			else
+				glBufferSubData(upload.target, upload.offset, upload.size, data);
+			GLState::BindBuffer(upload.target, 0);
+			Shape::UploadedBytes() += upload.size;
+			continue;
+		}
+		const Draw& draw = m_draws[command.index];
+		DrawItem item = draw.item;
+		if (draw.instanceBuffer != nullptr)
+			item.instanceBuffer = draw.instanceBuffer->get();
+		for (unsigned pass : passes)
+			queue.submit(pass, item);
+	}
+}
@@ -0,0 +1,302 @@
+#include "DrawQueue.h"
+
+#include <algorithm>
+#include <iostream>
+
+// Where each sort key field starts, from the top bit down, and how wide it is. The mesh takes the low 24 bits.
+static const int PASS_SHIFT = 60, DEPTH_SHIFT = 56, PROGRAM_SHIFT = 48, TEXTURE_SHIFT = 36, MATERIAL_SHIFT = 24;
+static const uint64_t DEPTH_MASK = 0xF, PROGRAM_MASK = 0xFF, TEXTURE_MASK = 0xFFF, MATERIAL_MASK = 0xFFF, MESH_MASK = 0xFFFFFF;
+static_assert(MAX_DRAW_PASSES <= 16 && DEPTH_SLICES <= DEPTH_MASK + 1, "Sort key fields are too narrow");
+
+// Model and normal matrix of meshes that are already in world space.
+static const glm::mat4 IDENTITY(1.0f);
+static const glm::mat3 NORMAL_IDENTITY(1.0f);
+
+// Inactive uniforms come back from ShaderProgram::location as -1, which the IDs hold as a GLuint.
+static bool isActive(const GLuint* id)
+{
+	return id != nullptr && (GLint)*id >= 0;
+}
+
+static bool sameLights(const ObjectLights& a, const ObjectLights& b)
+{
+	return std::equal(a.index, a.index + MAX_OBJECT_LIGHTS, b.index);
+}
+
+// Ids wider than their field wrap around. That only makes the order less tidy, never wrong, since state
+// changes are decided by comparing the objects themselves.
+static uint64_t idFor(std::unordered_map<const void*, uint32_t>& ids, const void* object, uint64_t mask)
+{
+	auto it = ids.find(object);
+	if (it == ids.end())
+		it = ids.emplace(object, (uint32_t)ids.size()).first;
+	return it->second & mask;
+}
+
+DrawQueue::ProgramState& DrawQueue::stateFor(const ShaderProgram& program)
+{
+	auto it = m_programs.find(&program);
+	if (it != m_programs.end())
+		return it->second;
+	// The shadow program samples nothing and has no mat, so its draws skip every material change.
+	ProgramState state;
+	state.samplesTexture = program.location("texture0") >= 0;
+	state.specularStrength = Uniform<GLfloat>(program.location("mat.specularStrength"));
+	state.shininess = Uniform<GLfloat>(program.location("mat.shininess"));
+	return m_programs.emplace(&program, state).first->second;
+}
+
+void DrawQueue::submit(unsigned pass, const DrawItem& item)
+{
+	if (pass >= MAX_DRAW_PASSES)
+	{
+		std::cout << "Draw pass " << pass << " is out of range!!! " << std::endl;
+		return;
+	}
+	m_keys.push_back({ sortKey(pass, item), (uint32_t)m_items.size() });
+	m_items.push_back(item);
+}
+
+uint64_t DrawQueue::sortKey(unsigned pass, const DrawItem& item)
+{
+	const Pass& info = m_passes[pass];
+	const ShaderProgram* program = info.program != nullptr ? info.program : item.material->program;
+	const ProgramState& state = stateFor(*program);
+	uint64_t key = (uint64_t)pass << PASS_SHIFT;
+	if (info.sortsDepth)
+		key |= (uint64_t)depthSlice(info, item.center) << DEPTH_SHIFT;
+	key |= idFor(m_programIds, program, PROGRAM_MASK) << PROGRAM_SHIFT;
+	// Left out where the program ignores them, so the shadow passes group by mesh alone.
+	if (state.samplesTexture)
+		key |= idFor(m_textureIds, item.material->texture, TEXTURE_MASK) << TEXTURE_SHIFT;
+	if (state.specularStrength.location() >= 0 || state.shininess.location() >= 0)
+		key |= idFor(m_materialIds, item.material, MATERIAL_MASK) << MATERIAL_SHIFT;
+	key |= idFor(m_meshIds, item.mesh, MESH_MASK);
+	return key;
+}
+
+unsigned DrawQueue::depthSlice(const Pass& pass, glm::vec3 center) const
+{
+	float depth = -(pass.view * glm::vec4(center, 1.0f)).z;
+	if (depth <= m_near)
+		return 0;
+	int slice = (int)((depth - m_near) / (m_far - m_near) * DEPTH_SLICES);
+	return std::min(slice, DEPTH_SLICES - 1);
+}
+
+void DrawQueue::sort()
+{
+	// Least significant byte first. Every scatter is stable, so equal keys keep the order they were submitted in.
+	size_t count = m_keys.size();
+	if (count < 2)
+		return;
+	size_t histograms[8][256] = {};
+	for (const SortEntry& entry : m_keys)
+	{
+		for (int digit = 0; digit < 8; digit++)
+			histograms[digit][(entry.key >> (digit * 8)) & 0xFF]++;
+	}
+	m_scratch.resize(count);
+	for (int digit = 0; digit < 8; digit++)
+	{
+		int shift = digit * 8;
+		size_t* histogram = histograms[digit];
+		// Most bytes are the same in every key of a frame, and scattering by those would move nothing.
+		if (histogram[(m_keys[0].key >> shift) & 0xFF] == count)
+			continue;
+		size_t offset = 0;
+		for (int value = 0; value < 256; value++)
+		{
+			size_t size = histogram[value];
+			histogram[value] = offset;
+			offset += size;
+		}
+		for (const SortEntry& entry : m_keys)
+			m_scratch[histogram[(entry.key >> shift) & 0xFF]++] = entry;
+		m_keys.swap(m_scratch);
+	}
+}
+
+void DrawQueue::flush()
+{
+	if (m_modelID == nullptr || m_useProgram == nullptr)
+	{
+		std::cout << "DrawQueue is not set up!!! " << std::endl;
+		m_items.clear();
+		m_keys.clear();
+		return;
+	}
+	sort();
+
+	// Other code binds programs and textures and writes model between flushes. Tint, instanced, indirect
+	// and object_lights are always left at their defaults, by restoreDefaults and by every other draw path.
+	m_program = nullptr;
+	m_state = nullptr;
+	m_texture = nullptr;
+	m_model = nullptr;
+	m_tint = glm::vec3(1.0f, 1.0f, 1.0f);
+	m_instanced = false;
+	m_indirect = false;
+	m_lights = NO_OBJECT_LIGHTS;
+	unsigned pass = MAX_DRAW_PASSES;
+	bool counting = true;
+	GLuint countedDraws = 0;
+	DrawStats countedStats = {};
+	for (const SortEntry& entry : m_keys)
+	{
+		const DrawItem& item = m_items[entry.item];
+		unsigned itemPass = (unsigned)(entry.key >> PASS_SHIFT);
+		if (itemPass != pass)
+		{
+			pass = itemPass;
+			// Uncounted passes run against saved counters, which come back once a counted pass starts.
+			if (counting != m_passes[pass].counted)
+			{
+				counting = m_passes[pass].counted;
+				if (!counting)
+				{
+					countedDraws = Shape::DrawCount();
+					countedStats = m_stats;
+				}
+				else
+				{
+					Shape::DrawCount() = countedDraws;
+					m_stats = countedStats;
+				}
+			}
+			if (m_passes[pass].program != nullptr)
+				useProgram(*m_passes[pass].program);
+			// The pass may bind textures of its own.
+			m_texture = nullptr;
+			if (m_beginPass != nullptr)
+				m_beginPass(pass);
+		}
+		useProgram(m_passes[pass].program != nullptr ? *m_passes[pass].program : *item.material->program);
+		applyMaterial(*m_state, *item.material);
+		applyDraw(item);
+		if (item.drawCount > 0)
+			item.mesh->DrawShapeIndirect(GL_TRIANGLES, item.commandBuffer, item.commandOffset, item.drawCount);
+		else if (item.instanceCount > 0)
+			item.mesh->DrawShapeInstanced(GL_TRIANGLES, item.instanceBuffer, item.instanceOffset, item.instanceCount);
+		else
+			item.mesh->DrawShape(GL_TRIANGLES);
+	}
+	restoreDefaults();
+	if (!counting)
+	{
+		Shape::DrawCount() = countedDraws;
+		m_stats = countedStats;
+	}
+	m_items.clear();
+	m_keys.clear();
+}
+
+void DrawQueue::useProgram(const ShaderProgram& program)
+{
+	if (&program == m_program)
+		return;
+	// What was tracked so far belongs to the program being left.
+	restoreDefaults();
+	m_useProgram(program);
+	m_stats.programBinds++;
+	m_program = &program;
+	m_state = &stateFor(program);
+	m_model = nullptr;
+}
+
+void DrawQueue::applyMaterial(ProgramState& state, const Material& material)
+{
+	if (state.samplesTexture && material.texture != m_texture)
+	{
+		material.texture->Bind(GL_TEXTURE0);
+		m_texture = material.texture;
+		m_stats.textureBinds++;
+	}
+	if (state.specularStrength.location() >= 0 && material.specularStrength != state.specularValue)
+	{
+		state.specularStrength.set(material.specularStrength);
+		state.specularValue = material.specularStrength;
+		m_stats.uniformUpdates++;
+	}
+	if (state.shininess.location() >= 0 && material.shininess != state.shininessValue)
+	{
+		state.shininess.set(material.shininess);
+		state.shininessValue = material.shininess;
+		m_stats.uniformUpdates++;
+	}
+}
+
+void DrawQueue::applyDraw(const DrawItem& item)
+{
+	bool indirect = item.drawCount > 0;
+	if (indirect != m_indirect && isActive(m_indirectID))
+	{
+		glUniform1i(*m_indirectID, indirect ? GL_TRUE : GL_FALSE);
+		m_stats.uniformUpdates++;
+	}
+	m_indirect = indirect;
+	bool instanced = item.instanceCount > 0;
+	if (instanced != m_instanced && isActive(m_instancedID))
+	{
+		glUniform1i(*m_instancedID, instanced ? GL_TRUE : GL_FALSE);
+		m_stats.uniformUpdates++;
+	}
+	m_instanced = instanced;
+	// Instances read matrices, tint and lights from the instance buffer, multi-draws from the Draws buffer.
+	if (instanced || indirect)
+		return;
+
+	const glm::mat4* model = item.model != nullptr ? item.model : &IDENTITY;
+	if (model != m_model)
+	{
+		m_model = model;
+		if (isActive(m_modelID))
+		{
+			glUniformMatrix4fv(*m_modelID, 1, GL_FALSE, &(*model)[0][0]);
+			m_stats.uniformUpdates++;
+		}
+		if (isActive(m_normalMatrixID))
+		{
+			const glm::mat3* normalMatrix = item.normalMatrix != nullptr ? item.normalMatrix : &NORMAL_IDENTITY;
+			glUniformMatrix3fv(*m_normalMatrixID, 1, GL_FALSE, &(*normalMatrix)[0][0]);
+			m_stats.uniformUpdates++;
+		}
+	}
+	if (item.tint != m_tint && isActive(m_tintID))
+	{
+		glUniform3f(*m_tintID, item.tint.x, item.tint.y, item.tint.z);
+		m_stats.uniformUpdates++;
+	}
+	m_tint = item.tint;
+	if (!sameLights(item.lights, m_lights))
+	{
+		// With its array disabled, object_lights reads this constant value instead.
+		glVertexAttribI4iv(OBJECT_LIGHTS_LOCATION, item.lights.index);
+		m_lights = item.lights;
+	}
+}
+
+void DrawQueue::restoreDefaults()
+{
+	if (m_instanced && isActive(m_instancedID))
+	{
+		glUniform1i(*m_instancedID, GL_FALSE);
+		m_stats.uniformUpdates++;
+	}
+	if (m_indirect && isActive(m_indirectID))
+	{
+		glUniform1i(*m_indirectID, GL_FALSE);
+		m_stats.uniformUpdates++;
+	}
+	if (m_tint != glm::vec3(1.0f, 1.0f, 1.0f) && isActive(m_tintID))
+	{
+		glUniform3f(*m_tintID, 1.0f, 1.0f, 1.0f);
+		m_stats.uniformUpdates++;
+	}
+	if (!sameLights(m_lights, NO_OBJECT_LIGHTS))
+		glVertexAttribI4iv(OBJECT_LIGHTS_LOCATION, NO_OBJECT_LIGHTS.index);
+	m_instanced = false;
+	m_indirect = false;
+	m_tint = glm::vec3(1.0f, 1.0f, 1.0f);
+	m_lights = NO_OBJECT_LIGHTS;
+}
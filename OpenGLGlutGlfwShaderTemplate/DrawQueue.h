@@ -0,0 +1,176 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Material.h"
+#include "ShaderProgram.h"
+#include "Shape.h"
+
+// Passes a frame can hold. The pass is the top field of every sort key, so lower passes run first.
+#define MAX_DRAW_PASSES 16
+// Depth slices opaque draws are ordered by, front to back. Coarse on purpose: ordering between slices
+// gets most of the early-z win, and draws within a slice still group by program, texture and mesh.
+#define DEPTH_SLICES 16
+
+// One draw call plus the per-draw state it needs on top of its mesh's VAO.
+struct DrawItem
+{
+	const Material* material;
+	Shape* mesh;
+	// nullptr for meshes already in world space and for instanced draws, which read their matrices per instance.
+	const glm::mat4* model;
+	const glm::mat3* normalMatrix;
+	glm::vec3 tint; // Single draws only. Instances carry their own.
+	ObjectLights lights; // Constant object_lights for single draws whose mesh has no per-vertex lists.
+	// instanceCount 0 draws the mesh once, anything else reads InstanceData from instanceBuffer at instanceOffset.
+	GLuint instanceBuffer;
+	GLintptr instanceOffset;
+	GLsizei instanceCount;
+	glm::vec3 center; // World-space center of what the draw covers, for the depth order.
+	// drawCount above 0 makes this one multi-draw of drawCount commands from commandBuffer at commandOffset.
+	// Every instance of those reads its matrices, tint and lights from the Draws storage buffer.
+	GLuint commandBuffer;
+	GLintptr commandOffset;
+	GLsizei drawCount;
+};
+
+// GL state changes made by DrawQueue flushes since the counters were last reset.
+struct DrawStats
+{
+	GLuint programBinds, textureBinds, uniformUpdates;
+
+	bool operator!=(const DrawStats& other) const
+	{
+		return programBinds != other.programBinds || textureBinds != other.textureBinds || uniformUpdates != other.uniformUpdates;
+	}
+};
+
+// Collects every draw of a frame as a packet with a 64-bit sort key, then radix sorts the keys and issues
+// the draws in that order. From the top, a key holds the pass, the draw's depth slice, its program, its
+// texture, its material and its mesh. So passes run in order, opaque draws go roughly front to back, and
+// a program, texture or material uniform only changes where the sorted draws change it.
+// A program keeps its uniform values while another one is current, so the material values are tracked
+// per program and survive between frames.
+class DrawQueue
+{
+public:
+	void setModelID(GLuint* modelId) {
+		m_modelID = modelId;
+	}
+	void setNormalMatrixID(GLuint* normalMatrixId) {
+		m_normalMatrixID = normalMatrixId;
+	}
+	void setInstancedID(GLuint* instancedId) {
+		m_instancedID = instancedId;
+	}
+	void setTintID(GLuint* tintId) {
+		m_tintID = tintId;
+	}
+	void setIndirectID(GLuint* indirectId) {
+		m_indirectID = indirectId;
+	}
+	// Called to make a program current. It has to point the IDs above at that program's uniforms.
+	void setProgramHook(void (*useProgram)(const ShaderProgram&)) {
+		m_useProgram = useProgram;
+	}
+	// Called when flush reaches the first draw of a pass, after the pass's program (if it has one) is current,
+	// so it can bind the pass's target and set its uniforms. It must not change the current program.
+	void setPassHook(void (*beginPass)(unsigned pass)) {
+		m_beginPass = beginPass;
+	}
+	// Draws in pass use program in place of their materials' programs. Material state program doesn't
+	// use is skipped. nullptr goes back to the materials' programs.
+	void setPassProgram(unsigned pass, const ShaderProgram* program) {
+		m_passes[pass].program = program;
+	}
+	// Leaves the draws, binds and uniform updates of pass out of Shape::DrawCount and stats, for passes
+	// that only run in some frames.
+	void setPassCounted(unsigned pass, bool counted) {
+		m_passes[pass].counted = counted;
+	}
+	// Depth range the depth slices split evenly. Should match the camera projection.
+	void setDepthRange(float zNear, float zFar) {
+		m_near = zNear;
+		m_far = zFar;
+	}
+	// Orders the draws of pass front to back from view. Passes without a view keep depth out of their keys.
+	// Set it before submitting the pass's draws.
+	void setPassView(unsigned pass, const glm::mat4& view) {
+		m_passes[pass].view = view;
+		m_passes[pass].sortsDepth = true;
+	}
+
+	// Pointers in item must stay valid until the next flush.
+	void submit(unsigned pass, const DrawItem& item);
+	// Sorts every draw submitted since the last flush, issues them pass by pass and empties the queue.
+	// The last program a draw switched to stays current afterwards.
+	void flush();
+
+	// Never reset here. The caller zeroes it once per frame, like Shape::DrawCount.
+	DrawStats& stats() { return m_stats; }
+
+private:
+	// What a program samples and how its material uniforms were last set.
+	struct ProgramState
+	{
+		bool samplesTexture;
+		Uniform<GLfloat> specularStrength, shininess;
+		GLfloat specularValue = -1.0f, shininessValue = -1.0f;
+	};
+
+	struct Pass
+	{
+		const ShaderProgram* program = nullptr;
+		bool sortsDepth = false;
+		bool counted = true;
+		glm::mat4 view;
+	};
+
+	struct SortEntry
+	{
+		uint64_t key;
+		uint32_t item;
+	};
+
+	uint64_t sortKey(unsigned pass, const DrawItem& item);
+	unsigned depthSlice(const Pass& pass, glm::vec3 center) const;
+	void sort();
+	ProgramState& stateFor(const ShaderProgram& program);
+	void useProgram(const ShaderProgram& program);
+	void applyMaterial(ProgramState& state, const Material& material);
+	void applyDraw(const DrawItem& item);
+	// Puts tint, instanced, indirect and object_lights back to the values every other draw path expects.
+	void restoreDefaults();
+
+	GLuint *m_modelID = nullptr;
+	GLuint *m_normalMatrixID = nullptr;
+	GLuint *m_instancedID = nullptr;
+	GLuint *m_tintID = nullptr;
+	GLuint *m_indirectID = nullptr;
+	void (*m_useProgram)(const ShaderProgram&) = nullptr;
+	void (*m_beginPass)(unsigned pass) = nullptr;
+
+	Pass m_passes[MAX_DRAW_PASSES];
+	float m_near = 0.1f, m_far = 100.0f;
+	std::vector<DrawItem> m_items;
+	std::vector<SortEntry> m_keys, m_scratch;
+	// Small numbers for the key fields, handed out the first time an object is seen and kept from then on.
+	std::unordered_map<const void*, uint32_t> m_programIds, m_textureIds, m_materialIds, m_meshIds;
+	std::unordered_map<const ShaderProgram*, ProgramState> m_programs;
+	DrawStats m_stats = {};
+
+	// State during a flush.
+	const ShaderProgram* m_program = nullptr;
+	ProgramState* m_state = nullptr;
+	const Texture* m_texture = nullptr;
+	const glm::mat4* m_model = nullptr;
+	glm::vec3 m_tint{1,1,1};
+	bool m_instanced = false;
+	bool m_indirect = false;
+	ObjectLights m_lights = NO_OBJECT_LIGHTS;
+
+};
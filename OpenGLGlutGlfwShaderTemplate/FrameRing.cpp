@@ -0,0 +1,147 @@
+#include "FrameRing.h"
+#include "Shape.h"
+
+#include <algorithm>
+#include <iostream>
+
+// One wait is at most this long before it is retried, in nanoseconds.
+static const GLuint64 FENCE_TIMEOUT = 1000000000;
+
+void FrameRing::create(GLsizeiptr frameBytes)
+{
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &m_uniformAlignment);
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &m_storageAlignment);
+	m_frameBytes = frameBytes;
+	m_wanted = 0;
+	createBuffer();
+	std::cout << "Frame ring of " << FRAME_RING_FRAMES << " x " << m_frameBytes << " bytes, "
+		<< (m_persistent ? "persistently mapped." : "written with glBufferSubData (no ARB_buffer_storage).") << std::endl;
+}
+
+void FrameRing::release()
+{
+	for (int i = 0; i < FRAME_RING_FRAMES; i++)
+	{
+		if (m_fences[i] != nullptr)
+			glDeleteSync(m_fences[i]);
+		m_fences[i] = nullptr;
+	}
+	if (m_mapped != nullptr)
+	{
+		GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_buffer.get());
+		glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+		GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		m_mapped = nullptr;
+	}
+	m_buffer.reset();
+	m_staging.clear();
+	m_used = 0;
+}
+
+void FrameRing::createBuffer()
+{
+	// Regions start on an offset every binding target accepts.
+	GLsizeiptr alignment = std::max(m_uniformAlignment, m_storageAlignment);
+	m_frameBytes = (m_frameBytes + alignment - 1) / alignment * alignment;
+	GLsizeiptr total = m_frameBytes * FRAME_RING_FRAMES;
+	m_buffer = GLBuffer::create();
+	Shape::BufferCount()++;
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_buffer.get());
+	if (GLEW_ARB_buffer_storage)
+	{
+		// Coherent, so writes reach the GPU without a flush or a barrier. Dynamic storage keeps the fallback possible.
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_COPY_WRITE_BUFFER, total, nullptr, flags | GL_DYNAMIC_STORAGE_BIT);
+		m_mapped = (char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, total, flags);
+		if (m_mapped == nullptr)
+			std::cout << "Unable to map the frame ring!!! " << std::endl;
+	}
+	else
+	{
+		glBufferData(GL_COPY_WRITE_BUFFER, total, nullptr, GL_STREAM_DRAW);
+	}
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	m_persistent = m_mapped != nullptr;
+	if (!m_persistent)
+		m_staging.assign(m_frameBytes, 0);
+}
+
+void FrameRing::waitFor(int region)
+{
+	GLsync fence = m_fences[region];
+	if (fence == nullptr)
+		return;
+	GLenum result = glClientWaitSync(fence, 0, 0);
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		m_stalls++;
+		// The first wait flushes, or the fence might never reach the GPU.
+		GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		do
+		{
+			result = glClientWaitSync(fence, flags, FENCE_TIMEOUT);
+			flags = 0;
+		} while (result == GL_TIMEOUT_EXPIRED);
+	}
+	if (result == GL_WAIT_FAILED)
+		std::cout << "Waiting on a frame ring fence failed!!! " << std::endl;
+	glDeleteSync(fence);
+	m_fences[region] = nullptr;
+}
+
+void FrameRing::beginFrame()
+{
+	if (!m_buffer)
+		return;
+	if (m_wanted > m_frameBytes)
+	{
+		// Every region goes, so every frame still in flight has to finish first.
+		for (int i = 0; i < FRAME_RING_FRAMES; i++)
+			waitFor(i);
+		GLsizeiptr frameBytes = std::max(m_wanted, m_frameBytes * 2);
+		release();
+		m_frameBytes = frameBytes;
+		createBuffer();
+		std::cout << "Frame ring grows to " << FRAME_RING_FRAMES << " x " << m_frameBytes << " bytes." << std::endl;
+	}
+	m_region = (m_region + 1) % FRAME_RING_FRAMES;
+	waitFor(m_region);
+	m_used = 0;
+}
+
+FrameRing::Allocation FrameRing::allocate(GLsizeiptr size, GLint alignment)
+{
+	GLsizeiptr start = (m_used + alignment - 1) / alignment * alignment;
+	m_wanted = std::max(m_wanted, start + size);
+	if (!m_buffer || start + size > m_frameBytes)
+		return { nullptr, 0, 0 };
+	m_used = start + size;
+	char* base = m_persistent ? m_mapped + m_region * m_frameBytes : &m_staging.front();
+	return { base + start, m_region * m_frameBytes + start, size };
+}
+
+void FrameRing::flush()
+{
+	if (m_persistent || m_used == 0)
+		return;
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, m_buffer.get());
+	glBufferSubData(GL_COPY_WRITE_BUFFER, m_region * m_frameBytes, m_used, &m_staging.front());
+	GLState::BindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void FrameRing::endFrame()
+{
+	if (!m_buffer)
+		return;
+	m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void FrameRing::bindUniform(GLuint binding, const Allocation& block) const
+{
+	GLState::BindBufferRange(GL_UNIFORM_BUFFER, binding, m_buffer.get(), block.offset, block.size);
+}
+
+void FrameRing::bindStorage(GLuint binding, const Allocation& block) const
+{
+	GLState::BindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, m_buffer.get(), block.offset, block.size);
+}
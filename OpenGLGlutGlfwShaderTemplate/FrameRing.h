@@ -0,0 +1,67 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <vector>
+
+#include "GLHandle.h"
+
+// Regions in the ring: one being written while the GPU may still be reading the two frames before it.
+#define FRAME_RING_FRAMES 3
+
+// Data that is rewritten every frame, sub-allocated from one GL buffer that stays mapped for good.
+// The buffer is split into FRAME_RING_FRAMES regions, and each frame writes straight into the next one,
+// so the driver copies nothing and never has to orphan or wait on a buffer the GPU is still reading.
+// A fence after each frame guards its region until the GPU is done with it.
+// Without ARB_buffer_storage the region is written to a CPU copy instead and sent by flush.
+class FrameRing
+{
+public:
+	// A block of the current frame's region. Only valid until the same region comes round again.
+	struct Allocation
+	{
+		void* data; // nullptr if the region was full.
+		GLintptr offset;
+		GLsizeiptr size;
+	};
+
+	// frameBytes is the size of each region. A frame that needs more gets it from the next beginFrame on.
+	void create(GLsizeiptr frameBytes);
+	void release();
+
+	// Moves to the next region, first waiting for the GPU to finish the frame that last used it.
+	void beginFrame();
+	// Makes this frame's writes visible to GL. Call after the last allocate and before the first command that reads them.
+	void flush();
+	// Fences the region. Call after the last command that reads it.
+	void endFrame();
+
+	// Blocks aligned for glBindBufferRange on GL_UNIFORM_BUFFER and GL_SHADER_STORAGE_BUFFER.
+	Allocation allocateUniform(GLsizeiptr size) { return allocate(size, m_uniformAlignment); }
+	Allocation allocateStorage(GLsizeiptr size) { return allocate(size, m_storageAlignment); }
+	void bindUniform(GLuint binding, const Allocation& block) const;
+	void bindStorage(GLuint binding, const Allocation& block) const;
+
+	// True if the buffer is persistently mapped, false for the glBufferSubData fallback.
+	bool persistent() const { return m_persistent; }
+	// Times beginFrame had to wait for the GPU since the counter was last reset.
+	int& stalls() { return m_stalls; }
+
+private:
+	Allocation allocate(GLsizeiptr size, GLint alignment);
+	void createBuffer();
+	void waitFor(int region);
+
+	GLBuffer m_buffer;
+	char* m_mapped = nullptr;
+	std::vector<char> m_staging;
+	GLsync m_fences[FRAME_RING_FRAMES] = {};
+	GLsizeiptr m_frameBytes = 0;
+	// Most a frame asked for since the buffer was created. More than m_frameBytes makes beginFrame grow it.
+	GLsizeiptr m_wanted = 0;
+	int m_region = 0;
+	GLsizeiptr m_used = 0;
+	GLint m_uniformAlignment = 256, m_storageAlignment = 256;
+	bool m_persistent = false;
+	int m_stalls = 0;
+
+};
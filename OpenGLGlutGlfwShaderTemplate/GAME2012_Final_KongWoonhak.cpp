@@ -37,10 +37,29 @@ using namespace std;
 #include <glm/gtc/matrix_transform.hpp>
 #include <string>
 #include <iostream>
+#include <chrono>
+#include <cstring>
 #include "Shape.h"
 #include "Light.h"
 #include "Texture.h"
 #include "MazeShape.h"
+#include "Maze.h"
+#include "MeshRegistry.h"
+#include "StaticBatch.h"
+#include "ShaderProgram.h"
+#include "LightBuffer.h"
+#include "ClusterGrid.h"
+#include "LightAssignment.h"
+#include "GBuffer.h"
+#include "GpuTimer.h"
+#include "ShadowCascades.h"
+#include "LightmapBaker.h"
+#include "Material.h"
+#include "DrawQueue.h"
+#include "FrameRing.h"
+#include "IndirectScene.h"
+#include "GLState.h"
+#include "WorkerPool.h"
 
 #define BUFFER_OFFSET(x)  ((const void*) (x))
 #define FPS 60
@@ -53,6 +72,14 @@ using namespace std;
 #define YZ_AXIS glm::vec3(0,1,1)
 #define XZ_AXIS glm::vec3(1,0,1)
 #define SPEED 0.25f
+//#define BENCHMARK_SHAPES // Print shape generation timings at startup.
+//#define BENCHMARK_LIGHTS // Print the CPU cost of re-uploading every light against dirty-only uploads.
+#define FRAME_TIME_FRAMES 120 // Frames averaged into each GPU frame time report.
+#define FRAME_RING_BYTES (1 << 20) // Starting size of each frame's region of frameRing. It grows if a frame needs more.
+#define CAMERA_BLOCK_BINDING 3 // Uniform block binding of Camera in the scene and lighting shaders.
+#define LIGHTING_SHADER "lighting.glsl" // Light blocks and functions shared by directional.frag and deferred.frag.
+#define LIGHTMAP_UNIT 5 // Matches the binding of lightmap in directional.frag.
+//#define BAKE_LIGHTMAP // Re-bake even if LIGHTMAP_FILE exists. Needed after changing the maze or the static lights, unless LightmapBake re-baked it.
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -69,13 +96,52 @@ enum keyMasks {
 	// Any other keys you want to add.
 };
 
-static unsigned int
-program,
-vertexShaderId,
-fragmentShaderId;
+static ShaderProgram program;
+// Deferred mode: gbufferProgram draws the scene into gBuffer, lightingProgram lights it in one screen pass.
+static ShaderProgram gbufferProgram, lightingProgram;
+// Depth-only program that renders the shadow casters into the cascades.
+static ShaderProgram shadowProgram;
 
-GLuint modelID, viewID, projID;
+// Locations of the directional.vert uniforms in the program the scene is currently drawn with.
+GLuint modelID, normalMatrixID, instancedID, tintID, indirectID;
+// The same locations in each program that runs directional.vert. useSceneProgram copies one set into the IDs above.
+struct SceneUniforms
+{
+	GLuint model, normalMatrix, instanced, tint, indirect;
+	Uniform<GLint> lightMode;
+};
+SceneUniforms forwardUniforms, gbufferUniforms, shadowUniforms;
+Uniform<glm::mat4> shadowViewProjection;
+Uniform<GLint> lightingLightMode;
+// std140 mirror of the Camera block. Every program reads the camera from it, so none needs its own view uniforms.
+struct GpuCamera
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::mat4 inverseViewProjection;
+	glm::vec3 eyePosition;
+	GLfloat pad;
+};
+static_assert(sizeof(GpuCamera) == 208, "GpuCamera does not match std140");
+// Per-frame data: the camera, and the cluster light lists on frames that rebuild them. Each frame writes its own region.
+FrameRing frameRing;
 glm::mat4 View, Projection;
+glm::mat4 GridModel; // The grid never moves, so its model matrix is built once in setupVAOs.
+glm::mat3 GridNormalMatrix;
+Aabb GridBounds; // World space.
+// The grid's per-object lights, reassigned only when lightBuffer reports a change.
+ObjectLights GridLights = NO_OBJECT_LIGHTS;
+unsigned gridLightVersion = 0;
+bool gridLightsAssigned = false;
+
+// Bytes uploaded to GL buffers during the last frame.
+size_t frameUploadedBytes = 0;
+// Draw calls issued by the last frame.
+GLuint frameDrawCalls = 0;
+// Program binds, texture binds and uniform updates drawQueue made during the last frame.
+DrawStats frameDrawStats = {};
+// GL state calls the last frame issued, and those the state cache dropped as redundant.
+GLuint frameStateCalls = 0, frameSkippedStateCalls = 0;
 
 // Our bitflag variable. 1 byte for up to 8 key states.
 unsigned char keys = 0; // Initialized to 0 or 0b00000000.
@@ -89,26 +155,16 @@ GLint width, height, bitDepth;
 glm::vec3 directionalLightPosition = glm::vec3(8.0f, 10.0f, 0.0f);
 
 // Light objects. Now OOP.
-AmbientLight aLight(
-	glm::vec3(1.0f, 1.0f, 1.0f),	// Diffuse color.
-	0.5f);
-// Diffuse strength.
-
-PointLight pLights[5] = { { glm::vec3(5.0f, 2, -5.0f), 50.0f, 1.0, 4.5f, 75.0f, glm::vec3(1.0f, 1.0f, 1.0f), 5 },
-						  { glm::vec3(25.0f, 2, -5.0f), 50.0f, 1.0, 4.5f, 75.0f, glm::vec3(1.0f, 1.0f, 1.0f), 5 },
-{ glm::vec3(5.0f, 2, -25.0f), 50.0f, 1.0, 4.5f, 75.0f, glm::vec3(1.0f, 1.0f, 1.0f), 5 },
-{ glm::vec3(25.0f, 2, -25.0f), 50.0f, 1.0, 4.5f, 75.0f, glm::vec3(1.0f, 1.0f, 1.0f), 5 },
-{ glm::vec3(15.0f, 2, -15.0f), 50.0f, 1.0, 4.5f, 75.0f, glm::vec3(1.0f, 1.0f, 1.0f), 0 }
-};
+AmbientLight aLight = mazeAmbientLight();
+vector<PointLight> pLights = mazePointLights();
+vector<SpotLight> sLights = mazeSpotLights();
 
 
 DirectionalLight dLight(
-	glm::vec3(1.0f, 1.0f, 1.0f),	// direction using the origin
-  //directionalLightPosition,
+  //glm::vec3(1.0f, 1.0f, 1.0f),	// direction using the origin
+	directionalLightPosition,
 	glm::vec3(1.0f, 1.0f, 1.0f),	// Diffuse color.
-	0.0f);							// Diffuse strength.
-
-Material mat = { 0.5f, 8 }; // Alternate way to construct an object.
+	0.5f);							// Diffuse strength.
 
 // Camera and transform variables.
 float scale = 1.0f, angle = 0.0f;
@@ -117,7 +173,7 @@ GLfloat pitch, yaw;
 int lastX, lastY;
 
 // Geometry data.
-Grid g_grid(41,1);
+Grid g_grid(MAZE_GRID_SIZE, 1);
 //Cube g_cube(1);
 //Prism g_prism(24);
 //Sphere g_sphere(5);
@@ -129,17 +185,86 @@ MazeShape roof;
 MazeShape door;
 MazeShape stair;
 MazeShape middleRoom;
+MazeGroups mazeGroups = { g_grid, hedges, wall, roof, door, stair, middleRoom };
+// The whole scene merged into one mesh per texture. Toggle with 'b'.
+StaticBatch staticScene;
+bool drawBaked = true;
+// The per-group scene as one multi-draw-indirect per material. Toggle with 'm'; off falls back to a draw per mesh.
+IndirectScene indirectScene;
+bool drawIndirect = true;
+// Per-cluster point light lists, rebuilt whenever the camera or the lights change.
+ClusterGrid clusters;
+// Which point lights each fragment loops over. Matches the LIGHTS_* values in lighting.glsl.
+enum LightMode { LIGHTS_ALL, LIGHTS_CLUSTERED, LIGHTS_PER_OBJECT, LIGHTS_BAKED, LIGHT_MODE_COUNT };
+LightMode lightMode = LIGHTS_CLUSTERED;
+// Passes of a frame, in the order drawQueue runs them. Shadow cascade i renders in PASS_SHADOW + i.
+enum RenderPass { PASS_SHADOW, PASS_GEOMETRY = PASS_SHADOW + SHADOW_CASCADES, PASS_FORWARD, PASS_COUNT };
+static_assert(PASS_COUNT <= MAX_DRAW_PASSES, "Too many render passes for the sort key");
+// Forward shades every fragment as it is drawn. Deferred shades each visible pixel once. Toggle with 'g'.
+bool deferred = false;
+GBuffer gBuffer;
+GpuTimer gpuTimer;
+// Shadows of the directional light. Cached, so a frame where neither the light nor the camera moved far renders none.
+ShadowCascades shadows;
+LightmapBaker lightmapBaker(LIGHTMAP_SIZE);
+std::unique_ptr<Texture> lightmapTexture;
+bool lightmapLoaded = false;
+
+// Everything that changes the cost of a frame. The GPU frame time is re-measured whenever it changes.
+struct RenderSetup
+{
+	bool deferred, baked, indirect, parallel;
+	LightMode lightMode;
+	size_t pointLights, spotLights;
+
+	bool operator!=(const RenderSetup& other) const
+	{
+		return deferred != other.deferred || baked != other.baked || indirect != other.indirect || parallel != other.parallel ||
+			lightMode != other.lightMode || pointLights != other.pointLights || spotLights != other.spotLights;
+	}
+};
+RenderSetup measuredSetup = {};
+bool frameTimeReported = true;
 
 void timer(int); // Prototype.
+void beginPass(unsigned pass);
 void makeMaze();
-
-Texture* hedgeTexture = nullptr;
-Texture* stoneTexture = nullptr;
-Texture* dirtTexture = nullptr;
-Texture* roofTexture = nullptr;
-Texture* woodTexture = nullptr;
-Texture* stoneFloorTexture = nullptr;
+void bakeScene();
+void buildIndirectScene();
+void loadLightmap();
+void calculateView();
+
+std::unique_ptr<Texture> hedgeTexture;
+std::unique_ptr<Texture> stoneTexture;
+std::unique_ptr<Texture> dirtTexture;
+std::unique_ptr<Texture> roofTexture;
+std::unique_ptr<Texture> woodTexture;
+std::unique_ptr<Texture> stoneFloorTexture;
 GLuint textureID;
+// One per kind of surface, set up in loadTextures. Every draw carries one.
+Material hedgeMaterial, stoneMaterial, dirtMaterial, roofMaterial, woodMaterial, stoneFloorMaterial;
+MazeMaterials mazeMaterials = { &dirtMaterial, &hedgeMaterial, &stoneMaterial, &roofMaterial, &woodMaterial, &stoneFloorMaterial };
+// Every draw of a frame goes through here, sorted by pass, depth and state so nothing has to be hand-ordered.
+DrawQueue drawQueue;
+// The groups of the per-group scene, each recorded into its own command list. The lists replay in this order.
+struct SceneGroup
+{
+	MazeShape* group;
+	glm::vec3 position;
+	const Material* material;
+};
+std::vector<SceneGroup> sceneGroups = { { &hedges, { 0, 0, 0 }, &hedgeMaterial }, { &wall, CASTLE_POSITION, &stoneMaterial },
+	{ &roof, CASTLE_POSITION, &roofMaterial }, { &stair, CASTLE_POSITION, &stoneFloorMaterial }, { &door, CASTLE_POSITION, &woodMaterial },
+	{ &middleRoom, { 0, 0, 0 }, &stoneFloorMaterial } };
+std::vector<CommandList> groupCommands;
+// Records the command lists next to the GL thread. Toggle with 'p'; off records them one after another on it.
+WorkerPool workers;
+bool recordParallel = true;
+// CPU time spent recording and replaying the per-group scene since the frame time was last re-measured.
+double recordMs = 0.0, replayMs = 0.0;
+// Window size of the current frame, for going back to the window after the shadow passes.
+int frameWidth, frameHeight;
+bool shadowPassesActive = false;
 
 void resetView()
 {
@@ -153,138 +278,284 @@ void resetView()
 
 void loadTextures()
 {
-	glUniform1i(glGetUniformLocation(program, "texture0"), 0);
-
-	hedgeTexture = new Texture(GL_TEXTURE_2D, "Media/grasshedge.jpg", GL_RGB);
+	hedgeTexture.reset(new Texture(GL_TEXTURE_2D, "Media/grasshedge.jpg", GL_RGB));
 	hedgeTexture->Bind(GL_TEXTURE0);
 	hedgeTexture->Load();
 
-	stoneTexture = new Texture(GL_TEXTURE_2D, "Media/stone2.png", GL_RGBA);
+	stoneTexture.reset(new Texture(GL_TEXTURE_2D, "Media/stone2.png", GL_RGBA));
 	stoneTexture->Bind(GL_TEXTURE0);
 	stoneTexture->Load();
 
-	dirtTexture = new Texture(GL_TEXTURE_2D, "Media/dirt2.png", GL_RGBA);
+	dirtTexture.reset(new Texture(GL_TEXTURE_2D, "Media/dirt2.png", GL_RGBA));
 	dirtTexture->Bind(GL_TEXTURE0);
 	dirtTexture->Load();
 
-	roofTexture = new Texture(GL_TEXTURE_2D, "Media/roof.jpg", GL_RGB);
+	roofTexture.reset(new Texture(GL_TEXTURE_2D, "Media/roof.jpg", GL_RGB));
 	roofTexture->Bind(GL_TEXTURE0);
 	roofTexture->Load();
 
-	woodTexture= new Texture(GL_TEXTURE_2D, "Media/wood.jpg", GL_RGB);
+	woodTexture.reset(new Texture(GL_TEXTURE_2D, "Media/wood.jpg", GL_RGB));
 	woodTexture->Bind(GL_TEXTURE0);
 	woodTexture->Load();
 
-	stoneFloorTexture = new Texture(GL_TEXTURE_2D, "Media/stone_floor.png", GL_RGB);
+	stoneFloorTexture.reset(new Texture(GL_TEXTURE_2D, "Media/stone_floor.png", GL_RGB));
 	stoneFloorTexture->Bind(GL_TEXTURE0);
 	stoneFloorTexture->Load();
 
-
+	// Foliage and dirt barely shine, dressed stone and roof tiles get a tighter highlight.
+	hedgeMaterial = { &program, hedgeTexture.get(), 0.1f, 4 };
+	stoneMaterial = { &program, stoneTexture.get(), 0.4f, 16 };
+	dirtMaterial = { &program, dirtTexture.get(), 0.05f, 2 };
+	roofMaterial = { &program, roofTexture.get(), 0.5f, 32 };
+	woodMaterial = { &program, woodTexture.get(), 0.25f, 8 };
+	stoneFloorMaterial = { &program, stoneFloorTexture.get(), 0.3f, 16 };
 
 }
 
+// The lights live in lightBuffer. Material values are set per draw by drawQueue.
+LightBuffer lightBuffer;
+
+// Copies the light objects into the light buffer. Only lights that changed since the last call get uploaded.
 void setupLights()
 {
-	// Setting material values.
-	glUniform1f(glGetUniformLocation(program, "mat.specularStrength"), mat.specularStrength);
-	glUniform1f(glGetUniformLocation(program, "mat.shininess"), mat.shininess);
-
-	// Setting ambient light.
-	glUniform3f(glGetUniformLocation(program, "aLight.base.diffuseColor"), aLight.diffuseColor.x, aLight.diffuseColor.y, aLight.diffuseColor.z);
-	glUniform1f(glGetUniformLocation(program, "aLight.base.diffuseStrength"), aLight.diffuseStrength);
-
-	// Setting directional light.
-	glUniform3f(glGetUniformLocation(program, "dLight.base.diffuseColor"), dLight.diffuseColor.x, dLight.diffuseColor.y, dLight.diffuseColor.z);
-	glUniform1f(glGetUniformLocation(program, "dLight.base.diffuseStrength"), dLight.diffuseStrength);
-	glUniform3f(glGetUniformLocation(program, "dLight.direction"), dLight.direction.x, dLight.direction.y, dLight.direction.z);
-
-	// Setting point light.
-
-	// Setting point lights.
-	glUniform3f(glGetUniformLocation(program, "pLights[0].base.diffuseColor"), pLights[0].diffuseColor.x, pLights[0].diffuseColor.y, pLights[0].diffuseColor.z);
-	glUniform1f(glGetUniformLocation(program, "pLights[0].base.diffuseStrength"), pLights[0].diffuseStrength);
-	glUniform3f(glGetUniformLocation(program, "pLights[0].position"), pLights[0].position.x, pLights[0].position.y, pLights[0].position.z);
-	glUniform1f(glGetUniformLocation(program, "pLights[0].constant"), pLights[0].constant);
-	glUniform1f(glGetUniformLocation(program, "pLights[0].linear"), pLights[0].linear);
-	glUniform1f(glGetUniformLocation(program, "pLights[0].quadratic"), pLights[0].quadratic);
-
-	glUniform3f(glGetUniformLocation(program, "pLights[1].base.diffuseColor"), pLights[1].diffuseColor.x, pLights[1].diffuseColor.y, pLights[1].diffuseColor.z);
-	glUniform1f(glGetUniformLocation(program, "pLights[1].base.diffuseStrength"), pLights[1].diffuseStrength);
-	glUniform3f(glGetUniformLocation(program, "pLights[1].position"), pLights[1].position.x, pLights[1].position.y, pLights[1].position.z);
-	glUniform1f(glGetUniformLocation(program, "pLights[1].constant"), pLights[1].constant);
-	glUniform1f(glGetUniformLocation(program, "pLights[1].linear"), pLights[1].linear);
-	glUniform1f(glGetUniformLocation(program, "pLights[1].quadratic"), pLights[1].quadratic);
-
-	glUniform3f(glGetUniformLocation(program, "pLights[2].base.diffuseColor"), pLights[2].diffuseColor.x, pLights[2].diffuseColor.y, pLights[2].diffuseColor.z);
-	glUniform1f(glGetUniformLocation(program, "pLights[2].base.diffuseStrength"), pLights[2].diffuseStrength);
-	glUniform3f(glGetUniformLocation(program, "pLights[2].position"), pLights[2].position.x, pLights[2].position.y, pLights[2].position.z);
-	glUniform1f(glGetUniformLocation(program, "pLights[2].constant"), pLights[2].constant);
-	glUniform1f(glGetUniformLocation(program, "pLights[2].linear"), pLights[2].linear);
-	glUniform1f(glGetUniformLocation(program, "pLights[2].quadratic"), pLights[2].quadratic);
-
-	glUniform3f(glGetUniformLocation(program, "pLights[3].base.diffuseColor"), pLights[3].diffuseColor.x, pLights[3].diffuseColor.y, pLights[3].diffuseColor.z);
-	glUniform1f(glGetUniformLocation(program, "pLights[3].base.diffuseStrength"), pLights[3].diffuseStrength);
-	glUniform3f(glGetUniformLocation(program, "pLights[3].position"), pLights[3].position.x, pLights[3].position.y, pLights[3].position.z);
-	glUniform1f(glGetUniformLocation(program, "pLights[3].constant"), pLights[3].constant);
-	glUniform1f(glGetUniformLocation(program, "pLights[3].linear"), pLights[3].linear);
-	glUniform1f(glGetUniformLocation(program, "pLights[3].quadratic"), pLights[3].quadratic);
-
-	glUniform3f(glGetUniformLocation(program, "pLights[4].base.diffuseColor"), pLights[4].diffuseColor.x, pLights[4].diffuseColor.y, pLights[4].diffuseColor.z);
-	glUniform1f(glGetUniformLocation(program, "pLights[4].base.diffuseStrength"), pLights[4].diffuseStrength);
-	glUniform3f(glGetUniformLocation(program, "pLights[4].position"), pLights[4].position.x, pLights[4].position.y, pLights[4].position.z);
-	glUniform1f(glGetUniformLocation(program, "pLights[4].constant"), pLights[4].constant);
-	glUniform1f(glGetUniformLocation(program, "pLights[4].linear"), pLights[4].linear);
-	glUniform1f(glGetUniformLocation(program, "pLights[4].quadratic"), pLights[4].quadratic);
+	lightBuffer.setAmbient(aLight);
+	lightBuffer.setDirectional(dLight);
+	lightBuffer.setPointCount(pLights.size());
+	for (size_t i = 0; i < pLights.size(); i++)
+		lightBuffer.setPoint(i, pLights[i]);
+	lightBuffer.setSpotCount(sLights.size());
+	for (size_t i = 0; i < sLights.size(); i++)
+		lightBuffer.setSpot(i, sLights[i]);
+	lightBuffer.upload();
+}
 
+// Replaces the torches with count new ones scattered over the maze floor.
+void setTorchCount(int count)
+{
+	pLights.erase(pLights.begin() + BASE_POINT_LIGHTS, pLights.end());
+	for (int i = 0; i < count; i++)
+	{
+		glm::vec3 position(-5.0f + 40.0f * rand() / RAND_MAX, 1.5f + rand() % 2, 6.0f - 40.0f * rand() / RAND_MAX);
+		pLights.push_back(PointLight(position, 6.0f, 1.0f, 4.5f, 75.0f, glm::vec3(1.0f, 0.6f, 0.25f), 3.0f));
+	}
+	cout << pLights.size() << " point lights." << endl;
 }
 
+// Replaces the lamps with count new downward spot lights scattered over the maze.
+void setLampCount(int count)
+{
+	sLights.erase(sLights.begin() + BASE_SPOT_LIGHTS, sLights.end());
+	for (int i = 0; i < count; i++)
+	{
+		glm::vec3 position(-5.0f + 40.0f * rand() / RAND_MAX, 3.0f + rand() % 2, 6.0f - 40.0f * rand() / RAND_MAX);
+		sLights.push_back(SpotLight(position, 6.0f, 1.0f, 4.5f, 75.0f, glm::vec3(0.6f, 0.8f, 1.0f), 3.0f, glm::vec3(0.0f, -1.0f, 0.0f), 20.0f));
+	}
+	cout << sLights.size() << " spot lights." << endl;
+}
+
+#ifdef BENCHMARK_LIGHTS
+void benchmarkLights()
+{
+	const int frames = 10000;
+	vector<GpuPointLight> all(pLights.size());
+	// The old behaviour: every light, every frame.
+	GLBuffer full = GLBuffer::create();
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, full.get());
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GpuPointLight) * all.size(), all.data(), GL_DYNAMIC_DRAW);
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < frames; i++)
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GpuPointLight) * all.size(), all.data());
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	// One point light moving every frame.
+	auto middle = chrono::steady_clock::now();
+	glm::vec3 original = pLights[0].position;
+	for (int i = 0; i < frames; i++)
+	{
+		pLights[0].position.x += 0.01f;
+		setupLights();
+	}
+	auto end = chrono::steady_clock::now();
+	pLights[0].position = original;
+	setupLights();
+	Shape::UploadedBytes() = 0;
+	cout << "Light upload CPU us/frame | full " << sizeof(GpuPointLight) * all.size() << " bytes: " << chrono::duration<double, micro>(middle - start).count() / frames
+		<< " | one light " << sizeof(GpuPointLight) << " bytes: " << chrono::duration<double, micro>(end - middle).count() / frames << endl;
+
+	// CPU cost of rebuilding the cluster lists, which happens whenever the camera moves.
+	cout << "Point lights | cluster build us | light indices" << endl;
+	ClusterGrid grid;
+	grid.setProjection(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+	calculateView();
+	for (int torches : { 0, 95, 995 })
+	{
+		setTorchCount(torches);
+		auto buildStart = chrono::steady_clock::now();
+		for (int i = 0; i < 100; i++)
+			grid.build(View, pLights, sLights);
+		auto buildEnd = chrono::steady_clock::now();
+		cout << pLights.size() << " | " << chrono::duration<double, micro>(buildEnd - buildStart).count() / 100 << " | " << grid.indexCount() << endl;
+	}
+	setTorchCount(0);
+}
+#endif
+
+#ifdef BENCHMARK_SHAPES
+void benchmarkShapes()
+{
+	cout << "Sphere subdivision | triangles | vertices | bytes | ms" << endl;
+	for (int level = 0; level <= 7; level++)
+	{
+		auto start = chrono::steady_clock::now();
+		Sphere sphere(level);
+		auto end = chrono::steady_clock::now();
+		size_t indexSize = sphere.IndexType() == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+		size_t bytes = sphere.NumVertices() * sizeof(Vertex) + sphere.NumIndices() * indexSize;
+		cout << level << " | " << sphere.NumIndices() / 3 << " | " << sphere.NumVertices() << " | " << bytes << " | "
+			<< chrono::duration<double, milli>(end - start).count() << endl;
+	}
+
+	// Flat grids from 1k to 10M triangles, same layout as Grid but without the per-shape overhead.
+	cout << "Normals triangles | serial ms | parallel ms" << endl;
+	for (int quads : { 23, 71, 224, 708, 2237 })
+	{
+		vector<GLfloat> vertices;
+		vector<GLuint> indices;
+		for (int row = 0; row <= quads; row++)
+		{
+			for (int col = 0; col <= quads; col++)
+				vertices.insert(vertices.end(), { (GLfloat)col, (GLfloat)row, 0.0f });
+		}
+		for (int row = 0; row < quads; row++)
+		{
+			for (int col = 0; col < quads; col++)
+			{
+				GLuint i = row * (quads + 1) + col;
+				indices.insert(indices.end(), { i, i + 1, i + quads + 2, i + quads + 2, i + quads + 1, i });
+			}
+		}
+		vector<GLfloat> normals(vertices.size());
+		auto start = chrono::steady_clock::now();
+		ComputeVertexNormalsSerial(indices.data(), indices.size(), vertices.data(), vertices.size() / 3, normals.data());
+		auto middle = chrono::steady_clock::now();
+		ComputeVertexNormals(indices.data(), indices.size(), vertices.data(), vertices.size() / 3, normals.data());
+		auto end = chrono::steady_clock::now();
+		cout << indices.size() / 3 << " | " << chrono::duration<double, milli>(middle - start).count() << " | "
+			<< chrono::duration<double, milli>(end - middle).count() << endl;
+	}
+}
+#endif
+
 void setupVAOs()
 {
 
 	// All VAO/VBO data now in Shape.h! But we still need to do this AFTER OpenGL is initialized.
+	int start = glutGet(GLUT_ELAPSED_TIME);
 	g_grid.BufferShape();
+	GridModel = mazeGridModel();
+	GridNormalMatrix = NormalMatrix(GridModel);
+	GridBounds = TransformBounds(g_grid.Bounds(), GridModel);
 	//g_cube.BufferShape();
 
 	makeMaze();
+	bakeScene();
+	buildIndirectScene();
+	int end = glutGet(GLUT_ELAPSED_TIME);
+	cout << "Scene built in " << (end - start) << " ms using " << Shape::BufferCount() << " GL buffers for "
+		<< MeshRegistry::Size() + 1 << " meshes." << endl;
+
+}
 
+// Resolves and initializes the directional.vert uniforms of a program. The program must be current.
+SceneUniforms setupSceneUniforms(const ShaderProgram& shader)
+{
+	SceneUniforms uniforms;
+	uniforms.model = shader.location("model");
+	uniforms.normalMatrix = shader.location("normalMatrix");
+	glm::mat3 identity(1.0f);
+	glUniformMatrix3fv(uniforms.normalMatrix, 1, GL_FALSE, &identity[0][0]);
+	uniforms.instanced = shader.location("instanced");
+	glUniform1i(uniforms.instanced, GL_FALSE);
+	uniforms.tint = shader.location("tint");
+	glUniform3f(uniforms.tint, 1.0f, 1.0f, 1.0f);
+	uniforms.indirect = shader.location("indirect");
+	glUniform1i(uniforms.indirect, GL_FALSE);
+	// The geometry pass does no lighting, so this comes back inactive there.
+	if (shader.location("lightMode") >= 0)
+		uniforms.lightMode = shader.uniform<GLint>("lightMode");
+	return uniforms;
+}
+
+// The lightmap only covers the baked scene. Everything else gets the baked lights from the clusters instead.
+LightMode shadedLightMode()
+{
+	return lightMode == LIGHTS_BAKED && !(drawBaked && lightmapLoaded) ? LIGHTS_CLUSTERED : lightMode;
+}
+
+// Makes shader current and points the shape IDs at its uniforms.
+void useSceneProgram(const ShaderProgram& shader, const SceneUniforms& uniforms)
+{
+	shader.use();
+	modelID = uniforms.model;
+	normalMatrixID = uniforms.normalMatrix;
+	instancedID = uniforms.instanced;
+	tintID = uniforms.tint;
+	indirectID = uniforms.indirect;
+	uniforms.lightMode.set(shadedLightMode());
+}
+
+// drawQueue switches to a material's program through this, so the IDs it writes follow the program.
+void useMaterialProgram(const ShaderProgram& shader)
+{
+	if (&shader == &gbufferProgram)
+		useSceneProgram(gbufferProgram, gbufferUniforms);
+	else if (&shader == &shadowProgram)
+		useSceneProgram(shadowProgram, shadowUniforms);
+	else
+		useSceneProgram(program, forwardUniforms);
 }
 
 void setupShaders()
 {
 	// Create shader program executable.
-	vertexShaderId = setShader((char*)"vertex", (char*)"directional.vert");
-	fragmentShaderId = setShader((char*)"fragment", (char*)"directional.frag");
-	program = glCreateProgram();
-	glAttachShader(program, vertexShaderId);
-	glAttachShader(program, fragmentShaderId);
-	glLinkProgram(program);
-
-	GLint Success;
-	glGetProgramiv(program, GL_LINK_STATUS, &Success);
-	if (Success == 0) {
-		char temp[1024];
-		glGetProgramInfoLog(program, 1024, 0, temp);
-		fprintf(stderr, "Failed to link program:\n%s\n", temp);
-		glDeleteProgram(program);
-		program = 0;
-		exit(EXIT_FAILURE);
-	}
-
-	glValidateProgram(program);
-	glGetProgramiv(program, GL_VALIDATE_STATUS, &Success);
-	if (Success == 0) {
-		char temp[1024];
-		glGetProgramInfoLog(program, 1024, 0, temp);
-		fprintf(stderr, "Invalid Shader program:\n%s\n", temp);
-		glDeleteProgram(program);
-		program = 0;
+	// Both lighting paths compile the same light code from lighting.glsl.
+	if (!program.build("directional.vert", "directional.frag", LIGHTING_SHADER) ||
+		!gbufferProgram.build("directional.vert", "gbuffer.frag") ||
+		!lightingProgram.build("deferred.vert", "deferred.frag", LIGHTING_SHADER) ||
+		!shadowProgram.build("shadow.vert", "shadow.frag"))
 		exit(EXIT_FAILURE);
+	cout << "Shader program has " << program.uniformCount() << " uniform locations." << endl;
+
+	gbufferProgram.use();
+	gbufferUniforms = setupSceneUniforms(gbufferProgram);
+
+	shadowProgram.use();
+	shadowUniforms = setupSceneUniforms(shadowProgram);
+	shadowViewProjection = shadowProgram.uniform<glm::mat4>("lightViewProjection");
+
+	lightingProgram.use();
+	lightingLightMode = lightingProgram.uniform<GLint>("lightMode");
+
+	program.use();
+	forwardUniforms = setupSceneUniforms(program);
+	program.uniform<GLint>("bakedPointLights").set(BASE_POINT_LIGHTS);
+	program.uniform<GLint>("bakedSpotLights").set(BASE_SPOT_LIGHTS);
+	useSceneProgram(program, forwardUniforms);
+	drawQueue.setModelID(&modelID);
+	drawQueue.setNormalMatrixID(&normalMatrixID);
+	drawQueue.setInstancedID(&instancedID);
+	drawQueue.setTintID(&tintID);
+	drawQueue.setIndirectID(&indirectID);
+	drawQueue.setProgramHook(useMaterialProgram);
+	drawQueue.setPassHook(beginPass);
+	for (int i = 0; i < SHADOW_CASCADES; i++)
+	{
+		drawQueue.setPassProgram(PASS_SHADOW + i, &shadowProgram);
+		// Cascades are only re-rendered when the camera or the light moves far, so they stay out of the per-frame counts.
+		drawQueue.setPassCounted(PASS_SHADOW + i, false);
 	}
-	glUseProgram(program);
-
-	modelID = glGetUniformLocation(program, "model");
-	viewID = glGetUniformLocation(program, "view");
-	projID = glGetUniformLocation(program, "projection");
+	drawQueue.setPassProgram(PASS_GEOMETRY, &gbufferProgram);
+	// Draws that don't feed object_lights see no per-object lights.
+	glVertexAttribI4iv(OBJECT_LIGHTS_LOCATION, NO_OBJECT_LIGHTS.index);
 }
 
 void init(void)
@@ -293,6 +564,9 @@ void init(void)
 
 	// Projection matrix : 45∞ Field of View, 1:1 ratio, display range : 0.1 unit <-> 100 units
 	Projection = glm::perspective(glm::radians(45.0f), 1.0f / 1.0f, 0.1f, 100.0f);
+	clusters.setProjection(glm::radians(45.0f), 1.0f / 1.0f, 0.1f, 100.0f);
+	shadows.setProjection(glm::radians(45.0f), 1.0f / 1.0f, 0.1f, 100.0f);
+	drawQueue.setDepthRange(0.1f, 100.0f);
 	// Or, for an ortho camera :
 	// Projection = glm::ortho(-3.0f, 3.0f, -3.0f, 3.0f, 0.0f, 100.0f); // In world coordinates
 
@@ -303,14 +577,25 @@ void init(void)
 
 	loadTextures();
 
+	lightBuffer.create();
+	frameRing.create(FRAME_RING_BYTES);
+	workers.start();
+	clusters.create();
+	gpuTimer.create();
+	shadows.create();
 	setupLights();
 
-	setupVAOs();
+#ifdef BENCHMARK_SHAPES
+	benchmarkShapes();
+#endif
+#ifdef BENCHMARK_LIGHTS
+	benchmarkLights();
+#endif
 
-	glUniformMatrix4fv(projID, 1, GL_FALSE, &Projection[0][0]);
+	setupVAOs();
 
 	// Enable depth testing and face culling.
-	glEnable(GL_DEPTH_TEST);
+	GLState::Enable(GL_DEPTH_TEST);
 
 	//glEnable(GL_BLEND);
 	//glBlendFunc(GL_ONE, GL_ZERO);
@@ -351,11 +636,11 @@ void init(void)
 
 
 	// Enable smoothing.
-	glEnable(GL_LINE_SMOOTH);
-	glEnable(GL_POLYGON_SMOOTH);
+	GLState::Enable(GL_LINE_SMOOTH);
+	GLState::Enable(GL_POLYGON_SMOOTH);
 
 
-	glEnable(GL_CULL_FACE);
+	GLState::Enable(GL_CULL_FACE);
 	glFrontFace(GL_CCW);
 	glCullFace(GL_BACK);
 
@@ -383,21 +668,133 @@ void calculateView()
 
 //---------------------------------------------------------------------
 //
-// transformModel
+// frame helpers
 //
-void transformObject(glm::vec3 scale, glm::vec3 rotationAxis, float rotationAngle, glm::vec3 translation) {
-	glm::mat4 Model;
-	Model = glm::mat4(1.0f);
-	Model = glm::translate(Model, translation);
-	Model = glm::rotate(Model, glm::radians(rotationAngle), rotationAxis);
-	Model = glm::scale(Model, scale);
-
-	// We must now update the View.
-	//calculateView();
-
-	glUniformMatrix4fv(modelID, 1, GL_FALSE, &Model[0][0]);
-	//glUniformMatrix4fv(viewID, 1, GL_FALSE, &View[0][0]);
-	//glUniformMatrix4fv(projID, 1, GL_FALSE, &Projection[0][0]);
+// Records every group of the per-group scene into its own command list, on the workers unless recordParallel
+// is off. Traversal, matrices, light assignment and instance data all happen here; no GL call does.
+void recordGroups()
+{
+	groupCommands.resize(sceneGroups.size());
+	auto record = [](int i) {
+		const SceneGroup& scene = sceneGroups[i];
+		groupCommands[i].clear();
+		scene.group->record(groupCommands[i], scene.position, scene.material);
+	};
+	if (recordParallel)
+		workers.run(sceneGroups.size(), record);
+	else
+	{
+		for (int i = 0; i < sceneGroups.size(); i++)
+			record(i);
+	}
+}
+
+// Queues every draw of the scene for each of passes. In what order they run is up to drawQueue.
+void submitScene(const std::vector<unsigned>& passes)
+{
+	if (drawBaked)
+	{
+		for (unsigned pass : passes)
+			staticScene.submit(drawQueue, pass);
+	}
+	else if (drawIndirect)
+	{
+		for (unsigned pass : passes)
+			indirectScene.submit(drawQueue, pass);
+	}
+	else
+	{
+		// Grid.
+		ObjectLights gridLights = NO_OBJECT_LIGHTS;
+		if (lightMode == LIGHTS_PER_OBJECT)
+		{
+			if (!gridLightsAssigned || lightBuffer.version() != gridLightVersion)
+			{
+				GridLights = AssignLights(GridBounds, pLights, sLights);
+				gridLightVersion = lightBuffer.version();
+				gridLightsAssigned = true;
+			}
+			gridLights = GridLights;
+		}
+		for (unsigned pass : passes)
+		{
+			drawQueue.submit(pass, { &dirtMaterial, &g_grid, &GridModel, &GridNormalMatrix, glm::vec3(1.0f, 1.0f, 1.0f), gridLights,
+				0, 0, 0, (GridBounds.min + GridBounds.max) * 0.5f });
+		}
+
+		auto start = chrono::steady_clock::now();
+		recordGroups();
+		auto recorded = chrono::steady_clock::now();
+		// Back on the GL thread, in group order, so uploads and draws land the same whatever thread recorded them.
+		for (const CommandList& commands : groupCommands)
+			commands.replay(drawQueue, passes);
+		auto replayed = chrono::steady_clock::now();
+		recordMs += chrono::duration<double, milli>(recorded - start).count();
+		replayMs += chrono::duration<double, milli>(replayed - recorded).count();
+	}
+}
+
+// Writes this frame's Camera block into frameRing and binds it.
+void writeCamera()
+{
+	FrameRing::Allocation block = frameRing.allocateUniform(sizeof(GpuCamera));
+	if (block.data == nullptr)
+		return; // Only before create. A frame always has room for the camera, which is allocated first.
+	GpuCamera camera = { View, Projection, glm::inverse(Projection * View), position, 0.0f };
+	// Mapped memory is slow to read from, so the block is built here and copied in whole.
+	memcpy(block.data, &camera, sizeof(camera));
+	frameRing.bindUniform(CAMERA_BLOCK_BINDING, block);
+}
+
+// Prints the average GPU time of the last FRAME_TIME_FRAMES frames, once per render setup.
+void reportFrameTime()
+{
+	RenderSetup setup = { deferred, drawBaked, drawIndirect, recordParallel, lightMode, pLights.size(), sLights.size() };
+	if (setup != measuredSetup)
+	{
+		measuredSetup = setup;
+		gpuTimer.restart();
+		shadows.renderCount() = 0;
+		recordMs = 0.0;
+		replayMs = 0.0;
+		frameTimeReported = false;
+	}
+	if (frameTimeReported || gpuTimer.frames() < FRAME_TIME_FRAMES)
+		return;
+	const char* modes[] = { "all", "clustered", "per-object", "baked" };
+	cout << (deferred ? "Deferred" : "Forward") << ", " << modes[lightMode] << " lights, " << pLights.size() << " point and " << sLights.size() << " spot lights, "
+		<< (drawBaked ? "baked" : (drawIndirect ? "indirect per-group" : "per-group")) << " scene: " << gpuTimer.averageMs() << " ms GPU per frame, "
+		<< shadows.renderCount() << " shadow cascade renders." << endl;
+	if (!drawBaked && !drawIndirect)
+	{
+		cout << "Recording the groups took " << recordMs / gpuTimer.frames() << " ms CPU per frame on "
+			<< (recordParallel ? workers.threads() + 1 : 1) << " threads, replaying them " << replayMs / gpuTimer.frames() << " ms." << endl;
+	}
+	frameTimeReported = true;
+}
+
+// Goes back to the window once the shadow passes, if any ran, are done.
+void endShadowPasses()
+{
+	if (!shadowPassesActive)
+		return;
+	shadows.endCascades(frameWidth, frameHeight);
+	shadowPassesActive = false;
+}
+
+// drawQueue calls this at the first draw of each pass, with the pass's program already current.
+void beginPass(unsigned pass)
+{
+	if (pass < PASS_GEOMETRY)
+	{
+		shadowPassesActive = true;
+		shadows.beginCascade(pass - PASS_SHADOW);
+		shadowViewProjection.set(shadows.viewProjection(pass - PASS_SHADOW));
+		return;
+	}
+	endShadowPasses();
+	if (pass == PASS_GEOMETRY)
+		gBuffer.bindForGeometry();
 }
 
 //---------------------------------------------------------------------
@@ -407,34 +804,77 @@ void transformObject(glm::vec3 scale, glm::vec3 rotationAxis, float rotationAngl
 void display(void)
 {
 	calculateView();
-	glUniformMatrix4fv(viewID, 1, GL_FALSE, &View[0][0]);
 	//you need this function here as light values might change
 	setupLights();
-
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-	//glBindTexture(GL_TEXTURE_2D, blankID); // Use this texture for all shapes.
-
-
-	// Grid.
-	dirtTexture->Bind(GL_TEXTURE0);
-	g_grid.RecolorShape(1.0, 1.0, 1.0);
-	transformObject(glm::vec3(1.0f, 1.0f, 1.0f), X_AXIS, -90.0f, glm::vec3(-5.0f, 0.0f, 6.0f));
-	g_grid.DrawShape(GL_TRIANGLES);
-	glBindTexture(GL_TEXTURE_2D, 0);
-
-	//waterTexture->Bind(GL_TEXTURE0);
-	hedges.draw({ 0, 0, 0 }, hedgeTexture);
-	//glBindTexture(GL_TEXTURE_2D, 0);
-
-	wall.draw({ -5, 0, 6 }, stoneTexture);
-
-	roof.draw({ -5, 0, 6 }, roofTexture);
-
-	stair.draw({ -5, 0, 6 }, stoneFloorTexture);
-
-	door.draw({ -5, 0, 6 }, woodTexture);
-
-	middleRoom.draw({ 0, 0, 0 }, stoneFloorTexture);
+	frameWidth = glutGet(GLUT_WINDOW_WIDTH);
+	frameHeight = glutGet(GLUT_WINDOW_HEIGHT);
+	clusters.setViewport(frameWidth, frameHeight);
+	frameRing.beginFrame();
+	writeCamera();
+	clusters.update(frameRing, View, pLights, sLights, lightBuffer.version());
+
+	// Shadow cascades that no longer cover their part of the view get re-rendered. Usually none.
+	shadows.update(View, dLight.direction);
+	std::vector<unsigned> passes;
+	for (int i = 0; i < SHADOW_CASCADES; i++)
+	{
+		if (shadows.isDirty(i))
+			passes.push_back(PASS_SHADOW + i);
+	}
+	// Forward shades surfaces as they are drawn, deferred only stores them in the geometry pass.
+	RenderPass scenePass = deferred ? PASS_GEOMETRY : PASS_FORWARD;
+	drawQueue.setPassView(scenePass, View);
+	passes.push_back(scenePass);
+	submitScene(passes);
+
+	frameRing.flush();
+	gpuTimer.begin();
+	if (deferred)
+		gBuffer.resize(frameWidth, frameHeight);
+	else
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	drawQueue.flush();
+	endShadowPasses();
+	if (deferred)
+	{
+		// Lighting pass: each covered pixel loops over the lights of its cluster, so the cost follows pixels times nearby lights.
+		gBuffer.bindForLighting();
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		lightingProgram.use();
+		lightingLightMode.set(lightMode);
+		GLState::Disable(GL_DEPTH_TEST);
+		gBuffer.drawFullscreen();
+		GLState::Enable(GL_DEPTH_TEST);
+		gBuffer.unbindTextures();
+	}
+	gpuTimer.end();
+	frameRing.endFrame();
+	reportFrameTime();
+	if (frameRing.stalls() > 0)
+		cout << "Waited for the GPU " << frameRing.stalls() << " times before reusing a frame ring region." << endl;
+	frameRing.stalls() = 0;
+
+	// Everything above is static, so any upload after the first frame means something got re-sent.
+	frameUploadedBytes = Shape::UploadedBytes();
+	Shape::UploadedBytes() = 0;
+	if (frameUploadedBytes > 0)
+		cout << "Uploaded " << frameUploadedBytes << " bytes to GL buffers this frame." << endl;
+	if (Shape::DrawCount() != frameDrawCalls)
+		cout << "display() now issues " << Shape::DrawCount() << " draw calls per frame." << endl;
+	frameDrawCalls = Shape::DrawCount();
+	Shape::DrawCount() = 0;
+	if (drawQueue.stats() != frameDrawStats)
+		cout << "display() now makes " << drawQueue.stats().programBinds << " program binds, " << drawQueue.stats().textureBinds
+			<< " texture binds and " << drawQueue.stats().uniformUpdates << " uniform updates per frame." << endl;
+	frameDrawStats = drawQueue.stats();
+	drawQueue.stats() = {};
+	if (GLState::IssuedCount() != frameStateCalls || GLState::SkippedCount() != frameSkippedStateCalls)
+		cout << "display() now issues " << GLState::IssuedCount() << " and skips " << GLState::SkippedCount()
+			<< " GL state calls per frame." << endl;
+	frameStateCalls = GLState::IssuedCount();
+	frameSkippedStateCalls = GLState::SkippedCount();
+	GLState::IssuedCount() = 0;
+	GLState::SkippedCount() = 0;
 
 	glutSwapBuffers(); // Now for a potentially smoother render.
 }
@@ -446,473 +886,67 @@ void idle() // Not even called.
 
 void makeMaze()
 {
-	float scaleX = 1;
-	float scaleZ = 1;
-	hedges.setModelID(&modelID);
-	wall.setModelID(&modelID);
-	roof.setModelID(&modelID);
-	door.setModelID(&modelID);
-	stair.setModelID(&modelID);
-	middleRoom.setModelID(&modelID);
-	// row 0
-	hedges.addShape(Cube(31, 2, 1), { glm::vec3(0,0,0) ,glm::vec3(31,2,1),glm::vec3(1,0,0),0 });
-	// row 1
-	hedges.addShape(Cube(1, 2, 1), { glm::vec3(0,0,-1) ,glm::vec3(1,2,1),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(1, 2, 1), { glm::vec3(2,0,-1) ,glm::vec3(1,2,1),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(1, 2, 1), { glm::vec3(12,0,-1) ,glm::vec3(1,2,1),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(1, 2, 1), { glm::vec3(24,0,-1) ,glm::vec3(1,2,1),glm::vec3(1,0,0),0 });
-	// row 2
-	hedges.addShape(Cube(1, 2, 1), { glm::vec3(0,0,-2) ,glm::vec3(1,2,1),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(3, 2, 1), { glm::vec3(2,0,-2) ,glm::vec3(3,2,1),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(13, 2, 1), { glm::vec3(6,0,-2) ,glm::vec3(13,2,1),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(3, 2, 1), { glm::vec3(20,0,-2) ,glm::vec3(3,2,1),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(1, 2, 1), { glm::vec3(24,0,-2) ,glm::vec3(1,2,1),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(5, 2, 1), { glm::vec3(26,0,-2) ,glm::vec3(5,2,1),glm::vec3(1,0,0),0 });
-	// row 3
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-3) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(2,0,-3) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(10,0,-3) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(14,0,-3) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(18,0,-3) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(20,0,-3) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(26,0,-3) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-3) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	// row 4
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 3;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(2,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(6,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 3;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(8,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(12,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 3;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(14,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(18,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(20,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 5;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(22,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(28,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 5
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(2,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(6,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(12,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(16,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(18,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(20,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(22,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(24,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(26,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(28,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 6
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-6) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 5;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(2,0,-6) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 7;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(8,0,-6) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(16,0,-6) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 3;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(18,0,-6) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(22,0,-6) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(24,0,-6) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(26,0,-6) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(28,0,-6) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-6) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 7
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-7) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(2,0,-7) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(4,0,-7) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(10,0,-7) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(16,0,-7) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(24,0,-7) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(28,0,-7) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-7) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 8
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-8) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(2,0,-8) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(4,0,-8) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 13;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(6,0,-8) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(20,0,-8) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 5;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(22,0,-8) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(28,0,-8) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-8) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 9
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-9) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(2,0,-9) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(4,0,-9) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(18,0,-9) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(20,0,-9) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(28,0,-9) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-9) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 10
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-10) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(2,0,-10) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 3;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(4,0,-10) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 13;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(8,0,-10) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(22,0,-10) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 5;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(24,0,-10) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-10) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 11
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-11) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(4,0,-11) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(6,0,-11) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(8,0,-11) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(10,0,-11) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(20,0,-11) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(24,0,-11) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(28,0,-11) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-11) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 12
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-12) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 3;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(2,0,-12) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(6,0,-12) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(8,0,-12) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(10,0,-12) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 3;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(20,0,-12) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(24,0,-12) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(26,0,-12) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 3;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(28,0,-12) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 13
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-13) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(4,0,-13) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(6,0,-13) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(8,0,-13) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(10,0,-13) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(20,0,-13) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(26,0,-13) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(28,0,-13) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-13) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 14
-	scaleX = 3;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-14) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(4,0,-14) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(6,0,-14) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(8,0,-14) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(10,0,-14) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 3;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(20,0,-14) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(24,0,-14) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(28,0,-14) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-14) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 15
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-15) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(10,0,-15) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(20,0,-15) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(24,0,-15) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(26,0,-15) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-15) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 16
-	scaleX = 5;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-16) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(6,0,-16) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(20,0,-16) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 3;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(26,0,-16) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-16) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 17
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-17) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(10,0,-17) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(20,0,-17) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(24,0,-17) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(28,0,-17) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-17) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 18
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-18) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(2,0,-18) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 7;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(4,0,-18) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 3;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(20,0,-18) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(24,0,-18) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(28,0,-18) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-18) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 19
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-19) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(2,0,-19) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(4,0,-19) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(10,0,-19) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(20,0,-19) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(26,0,-19) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-19) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 20
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-20) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 3;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(2,0,-20) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(6,0,-20) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 3;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(12,0,-20) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 7;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(16,0,-20) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 3;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(24,0,-20) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(28,0,-20) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-20) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 21
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-21) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(6,0,-21) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(14,0,-21) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(20,0,-21) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(26,0,-21) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(28,0,-21) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-21) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 22
-	scaleX = 3;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-22) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 7;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(4,0,-22) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(12,0,-22) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 3;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(14,0,-22) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(18,0,-22) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(22,0,-22) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(24,0,-22) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-22) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 3;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(26,0,-22) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 23
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-23) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(2,0,-23) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(12,0,-23) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(14,0,-23) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(18,0,-23) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(22,0,-23) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(24,0,-23) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-23) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 24
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-24) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(6,0,-24) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(8,0,-24) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(10,0,-24) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(12,0,-24) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(14,0,-24) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-24) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 3;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(2,0,-24) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 7;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(16,0,-24) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 5;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(24,0,-24) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 25
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(4,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(6,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(8,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(10,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(12,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(14,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(18,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(22,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(26,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(28,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 26
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(4,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(6,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(16,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(18,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(26,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(28,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 3;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(4,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(8,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(12,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 5;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(20,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 27
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-27) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(6,0,-27) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(10,0,-27) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(12,0,-27) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(16,0,-27) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(18,0,-27) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(20,0,-27) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(26,0,-27) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(28,0,-27) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-27) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 28
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-28) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(20,0,-28) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(28,0,-28) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-28) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 11;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(2,0,-28) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 5;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(14,0,-28) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(22,0,-28) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 29
-	scaleX = 1;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(2,0,-29) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(22,0,-29) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(30,0,-29) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// row 30
-	scaleX = 31;
-	hedges.addShape(Cube(scaleX, 2, scaleZ), { glm::vec3(0,0,-30) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
-
-	// wall
-	scaleX = 3;
-	scaleZ = 38;
-	wall.addShape(Cube(scaleX, 6, scaleZ), { glm::vec3(0,0,-41) ,glm::vec3(scaleX,6,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 3;
-	scaleZ = 38;
-	wall.addShape(Cube(scaleX, 6, scaleZ), { glm::vec3(38,0,-41) ,glm::vec3(scaleX,6,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 35;
-	scaleZ = 3;
-	wall.addShape(Cube(scaleX, 6, scaleZ), { glm::vec3(3,0,-41) ,glm::vec3(scaleX,6,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 17;
-	scaleZ = 3;
-	wall.addShape(Cube(scaleX, 6, scaleZ), { glm::vec3(0,0,-3) ,glm::vec3(scaleX,6,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 17;
-	scaleZ = 3;
-	wall.addShape(Cube(scaleX, 6, scaleZ), { glm::vec3(24,0,-3) ,glm::vec3(scaleX,6,scaleZ),glm::vec3(1,0,0),0 });
-	scaleX = 7;
-	scaleZ = 3;
-	wall.addShape(Cube(scaleX, 1, scaleZ), { glm::vec3(17,5,-3) ,glm::vec3(scaleX,1,scaleZ),glm::vec3(1,0,0),0 });
-
-	scaleX = 0.5f;
-	scaleZ = 0.5f;
-	//south crenel
-	for(int i = 1; i < 40; i++)
-	{
-		wall.addShape(Cube(0.5f, 0.5f, 0.5f), { glm::vec3(i,6,-0.5) ,glm::vec3(scaleX,0.5f,scaleZ),glm::vec3(1,0,0),0 });
-		wall.addShape(Cube(0.5f, 0.5f, 0.5f), { glm::vec3(i,6,-41) ,glm::vec3(scaleX,0.5f,scaleZ),glm::vec3(1,0,0),0 });
-		wall.addShape(Cube(0.5f, 0.5f, 0.5f), { glm::vec3(0,6,-i-1) ,glm::vec3(scaleX,0.5f,scaleZ),glm::vec3(1,0,0),0 });
-		wall.addShape(Cube(0.5f, 0.5f, 0.5f), { glm::vec3(40.5f,6,-i - 1) ,glm::vec3(scaleX,0.5f,scaleZ),glm::vec3(1,0,0),0 });
-	}
+	hedges.setLights(&pLights, &sLights, &lightBuffer);
+	wall.setLights(&pLights, &sLights, &lightBuffer);
+	roof.setLights(&pLights, &sLights, &lightBuffer);
+	door.setLights(&pLights, &sLights, &lightBuffer);
+	stair.setLights(&pLights, &sLights, &lightBuffer);
+	middleRoom.setLights(&pLights, &sLights, &lightBuffer);
+	addMazeShapes(mazeGroups);
+}
 
-	for (int i = 3; i < 38; i++)
+// Same groups and positions submitScene() draws, merged per material. Nothing in the maze moves after makeMaze().
+void bakeScene()
+{
+	staticScene.setLights(&pLights, &sLights, &lightBuffer);
+	addMazeToBatch(staticScene, mazeGroups, mazeMaterials);
+	bool unwrapped = staticScene.unwrapLightmap(lightmapBaker);
+	staticScene.build();
+	shadows.setSceneBounds(staticScene.bounds());
+	if (unwrapped)
+		loadLightmap();
+	else
+		cout << "Static scene does not fit a " << LIGHTMAP_SIZE << " lightmap!!! " << endl;
+}
+
+// Same groups and positions submitScene() draws, with every mesh in one arena. Unlike the baked scene it reads
+// the groups again each frame, so entries can still move and recolor.
+void buildIndirectScene()
+{
+	indirectScene.setLights(&pLights, &sLights, &lightBuffer);
+	indirectScene.add(g_grid, GridModel, &dirtMaterial);
+	indirectScene.add(hedges, { 0, 0, 0 }, &hedgeMaterial);
+	indirectScene.add(wall, CASTLE_POSITION, &stoneMaterial);
+	indirectScene.add(roof, CASTLE_POSITION, &roofMaterial);
+	indirectScene.add(stair, CASTLE_POSITION, &stoneFloorMaterial);
+	indirectScene.add(door, CASTLE_POSITION, &woodMaterial);
+	indirectScene.add(middleRoom, { 0, 0, 0 }, &stoneFloorMaterial);
+	indirectScene.build();
+}
+
+// Loads LIGHTMAP_FILE, baking and writing it first if needed. Only the base lights exist at startup, so those are what gets baked.
+void loadLightmap()
+{
+	lightmapTexture.reset(new Texture(GL_TEXTURE_2D, LIGHTMAP_FILE, GL_RGB16F));
+#ifndef BAKE_LIGHTMAP
+	lightmapLoaded = lightmapTexture->LoadHdr();
+#endif
+	if (!lightmapLoaded)
 	{
-		wall.addShape(Cube(0.5f, 0.5f, 0.5f), { glm::vec3(i,6,-3) ,glm::vec3(scaleX,0.5f,scaleZ),glm::vec3(1,0,0),0 });
-		wall.addShape(Cube(0.5f, 0.5f, 0.5f), { glm::vec3(i,6,-38.5f) ,glm::vec3(scaleX,0.5f,scaleZ),glm::vec3(1,0,0),0 });
-		wall.addShape(Cube(0.5f, 0.5f, 0.5f), { glm::vec3(2.5,6,-i - 1) ,glm::vec3(scaleX,0.5f,scaleZ),glm::vec3(1,0,0),0 });
-		wall.addShape(Cube(0.5f, 0.5f, 0.5f), { glm::vec3(38,6,-i - 1) ,glm::vec3(scaleX,0.5f,scaleZ),glm::vec3(1,0,0),0 });
+		int start = glutGet(GLUT_ELAPSED_TIME);
+		lightmapBaker.bake(aLight, pLights, sLights);
+		int end = glutGet(GLUT_ELAPSED_TIME);
+		cout << "Baked " << lightmapBaker.chartCount() << " lightmap charts at " << lightmapBaker.texelsPerUnit()
+			<< " texels per unit in " << (end - start) << " ms." << endl;
+		if (!lightmapBaker.write(LIGHTMAP_FILE))
+			cout << "Unable to write " << LIGHTMAP_FILE << endl;
+		lightmapLoaded = lightmapTexture->LoadHdr();
 	}
-	scaleX = 5;
-	scaleZ = 5;
-	wall.addShape(Prism(18), { glm::vec3(-1,0,-4) ,glm::vec3(scaleX,10,scaleZ),glm::vec3(1,0,0),0 });
-	wall.addShape(Prism(18), { glm::vec3(37,0,-4) ,glm::vec3(scaleX,10,scaleZ),glm::vec3(1,0,0),0 });
-	wall.addShape(Prism(18), { glm::vec3(-1,0,-42) ,glm::vec3(scaleX,10,scaleZ),glm::vec3(1,0,0),0 });
-	wall.addShape(Prism(18), { glm::vec3(37,0,-42) ,glm::vec3(scaleX,10,scaleZ),glm::vec3(1,0,0),0 });
-
-	wall.addShape(Prism(8), { glm::vec3(13,0,-4) ,glm::vec3(scaleX,8,scaleZ),glm::vec3(1,0,0),0 });
-	wall.addShape(Prism(8), { glm::vec3(23,0,-4) ,glm::vec3(scaleX,8,scaleZ),glm::vec3(1,0,0),0 });
-
-	scaleX = 7;
-	scaleZ = 7;
-	roof.addShape(Cone(18), { glm::vec3(-2,10,-5) ,glm::vec3(scaleX,3,scaleZ),glm::vec3(1,0,0),0 });
-	roof.addShape(Cone(18), { glm::vec3(36,10,-5) ,glm::vec3(scaleX,3,scaleZ),glm::vec3(1,0,0),0 });
-	roof.addShape(Cone(18), { glm::vec3(-2,10,-43) ,glm::vec3(scaleX,3,scaleZ),glm::vec3(1,0,0),0 });
-	roof.addShape(Cone(18), { glm::vec3(36,10,-43) ,glm::vec3(scaleX,3,scaleZ),glm::vec3(1,0,0),0 });
-
-	roof.addShape(Cone(8), { glm::vec3(12,8,-5) ,glm::vec3(scaleX,3,scaleZ),glm::vec3(1,0,0),0 });
-	roof.addShape(Cone(8), { glm::vec3(22,8,-5) ,glm::vec3(scaleX,3,scaleZ),glm::vec3(1,0,0),0 });
-
-	scaleX = 10;
-	scaleZ = 3;
-	stair.addShape(Cube(scaleX,0.5f, scaleZ), { glm::vec3(15,0,-3) ,glm::vec3(scaleX,0.5f,scaleZ),glm::vec3(1,0,0),0 });
-	scaleZ = 2;
-	stair.addShape(Cube(scaleX, 0.5f, scaleZ), { glm::vec3(15,0.5,-2.5) ,glm::vec3(scaleX,0.5f,scaleZ),glm::vec3(1,0,0),0 });
-
-	scaleX = 2.5;
-	scaleZ = 0.1;
-	door.addShape(Cube(scaleX, 4, scaleZ), { glm::vec3(18,1,-1.5) ,glm::vec3(scaleX,4,scaleZ),glm::vec3(1,0,0),0 });
-	door.addShape(Cube(scaleX, 4, scaleZ), { glm::vec3(21,1,-1.5) ,glm::vec3(scaleX,4,scaleZ),glm::vec3(1,0,0),0 });
-
-
-	scaleX = 9;
-	scaleZ = 9;
-	middleRoom.addShape(Cube(scaleX, 0.5, scaleZ), { glm::vec3(11,0,-19) ,glm::vec3(scaleX,0.5,scaleZ),glm::vec3(1,0,0),0 });
-
-	scaleX = 1;
-	scaleZ = 1;
-	middleRoom.addShape(Cube(scaleX, 3, scaleZ), { glm::vec3(13,0.5,-17) ,glm::vec3(scaleX,3,scaleZ),glm::vec3(1,0,0),0 });
-	middleRoom.addShape(Cube(scaleX, 3, scaleZ), { glm::vec3(17,0.5,-17) ,glm::vec3(scaleX,3,scaleZ),glm::vec3(1,0,0),0 });
-	middleRoom.addShape(Cube(scaleX, 3, scaleZ), { glm::vec3(13,0.5,-13) ,glm::vec3(scaleX,3,scaleZ),glm::vec3(1,0,0),0 });
-	middleRoom.addShape(Cube(scaleX, 3, scaleZ), { glm::vec3(17,0.5,-13) ,glm::vec3(scaleX,3,scaleZ),glm::vec3(1,0,0),0 });
-
-	scaleX = 9;
-	scaleZ = 9;
-	middleRoom.addShape(Cube(scaleX, 0.5, scaleZ), { glm::vec3(11,3.5,-19) ,glm::vec3(scaleX,0.5,scaleZ),glm::vec3(1,0,0),0 });
-
+	if (!lightmapLoaded)
+		return;
+	// Like the shadow map, it stays on its own unit for good.
+	lightmapTexture->Bind(GL_TEXTURE0 + LIGHTMAP_UNIT);
+	GLState::ActiveTexture(GL_TEXTURE0);
 }
 
 void parseKeys()
@@ -975,6 +1009,48 @@ void keyDown(unsigned char key, int x, int y)
 		if (!(keys & KEY_DOWN))
 			keys |= KEY_DOWN;
 		break;
+	case 'b':
+		drawBaked = !drawBaked;
+		cout << (drawBaked ? "Drawing baked scene." : "Drawing per-group scene.") << endl;
+		break;
+	case 'm':
+		drawIndirect = !drawIndirect;
+		cout << (drawIndirect ? "Per-group scene draws with one multi-draw-indirect per material." : "Per-group scene draws each mesh on its own.") << endl;
+		break;
+	case 'p':
+		recordParallel = !recordParallel;
+		if (recordParallel)
+			cout << "Recording the per-group scene on " << workers.threads() + 1 << " threads." << endl;
+		else
+			cout << "Recording the per-group scene on the GL thread." << endl;
+		break;
+	case 'l':
+		// Cycles 5 -> 100 -> 1000 point lights.
+		setTorchCount(pLights.size() == BASE_POINT_LIGHTS ? 95 : (pLights.size() < 1000 ? 995 : 0));
+		break;
+	case 'k':
+		// Cycles 4 -> 100 -> 1000 spot lights.
+		setLampCount(sLights.size() == BASE_SPOT_LIGHTS ? 96 : (sLights.size() < 1000 ? 996 : 0));
+		break;
+	case 'c':
+		// Cycles clustered -> per-object -> baked -> every light.
+		lightMode = (LightMode)((lightMode + 1) % LIGHT_MODE_COUNT);
+		if (lightMode == LIGHTS_CLUSTERED)
+			cout << "Clustered point and spot lights." << endl;
+		else if (lightMode == LIGHTS_PER_OBJECT)
+			cout << "Up to " << MAX_OBJECT_LIGHTS << " point or spot lights per object." << endl;
+		else if (lightMode == LIGHTS_BAKED)
+			cout << "Base lights from the lightmap" << (drawBaked ? "" : " (baked scene only)") << ", only added lights are shaded per fragment." << endl;
+		else
+			cout << "Every fragment loops over every point and spot light." << endl;
+		break;
+	case 'g':
+		deferred = !deferred;
+		if (deferred)
+			cout << "Deferred shading." << (lightMode == LIGHTS_PER_OBJECT || lightMode == LIGHTS_BAKED ? " Per-object light lists and the lightmap fall back to clusters." : "") << endl;
+		else
+			cout << "Forward shading." << endl;
+		break;
 	default:
 		break;
 	}
@@ -986,27 +1062,27 @@ void keyDownSpec(int key, int x, int y) // x and y is mouse location upon key pr
 	{
 	case GLUT_KEY_UP: // Up arrow.
 		directionalLightPosition.y += 1 * MOVESPEED;
-		//dLight.direction = directionalLightPosition;
+		dLight.direction = directionalLightPosition;
 		break;
 	case GLUT_KEY_DOWN: // Down arrow.
 		directionalLightPosition.y -= 1 * MOVESPEED;
-		//dLight.direction = directionalLightPosition;
+		dLight.direction = directionalLightPosition;
 		break;
 	case GLUT_KEY_LEFT: // Left arrow.
 		directionalLightPosition.x -= 1 * MOVESPEED;
-		//dLight.direction = directionalLightPosition;
+		dLight.direction = directionalLightPosition;
 		break;
 	case GLUT_KEY_RIGHT: // DoRightwn arrow.
 		directionalLightPosition.x += 1 * MOVESPEED;
-		//dLight.direction = directionalLightPosition;
+		dLight.direction = directionalLightPosition;
 		break;
 	case GLUT_KEY_PAGE_UP: // PAGE UP.
 		directionalLightPosition.z -= 1 * MOVESPEED;
-		//dLight.direction = directionalLightPosition;
+		dLight.direction = directionalLightPosition;
 		break;
 	case GLUT_KEY_PAGE_DOWN: // PAGE DOWN.
 		directionalLightPosition.z += 1 * MOVESPEED;
-		//dLight.direction = directionalLightPosition;
+		dLight.direction = directionalLightPosition;
 		break;
 	default:
 		break;
@@ -1095,6 +1171,38 @@ void clean()
 {
 	cout << "Cleaning up!" << endl;
 	glDeleteTextures(1, &blankID);
+
+	// Tear the scene down while the context is still current, rather than leaving it to static destructors.
+	staticScene.clear();
+	indirectScene.clear();
+	hedges.clear();
+	wall.clear();
+	roof.clear();
+	stair.clear();
+	door.clear();
+	middleRoom.clear();
+	g_grid.ReleaseBuffers();
+	hedgeTexture.reset();
+	stoneTexture.reset();
+	dirtTexture.reset();
+	roofTexture.reset();
+	woodTexture.reset();
+	stoneFloorTexture.reset();
+	lightmapTexture.reset();
+	clusters.release();
+	frameRing.release();
+	lightBuffer.release();
+	workers.stop();
+	groupCommands.clear();
+	gBuffer.release();
+	gpuTimer.release();
+	shadows.release();
+	program.release();
+	gbufferProgram.release();
+	lightingProgram.release();
+	shadowProgram.release();
+	if (LiveGLObjects() != 0)
+		cout << LiveGLObjects() << " GL objects were not released!" << endl;
 }
 
 //---------------------------------------------------------------------
@@ -0,0 +1,80 @@
+#include <iostream>
+
+#include "GBuffer.h"
+#include "Shape.h"
+
+void GBuffer::resize(int width, int height)
+{
+	if (m_framebuffer && width == m_width && height == m_height)
+		return;
+	m_width = width;
+	m_height = height;
+
+	m_framebuffer = GLFramebuffer::create();
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer.get());
+	allocate(m_albedo, GL_RGBA8, GL_COLOR_ATTACHMENT0);
+	allocate(m_normal, GL_RGBA16F, GL_COLOR_ATTACHMENT1);
+	allocate(m_depth, GL_DEPTH_COMPONENT32F, GL_DEPTH_ATTACHMENT);
+	const GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+	glDrawBuffers(2, drawBuffers);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "G-buffer framebuffer is incomplete!!! " << std::endl;
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (!m_screenVao)
+		m_screenVao = GLVertexArray::create();
+}
+
+void GBuffer::allocate(GLTexture& texture, GLenum format, GLenum attachment)
+{
+	texture = GLTexture::create();
+	GLState::ActiveTexture(GL_TEXTURE0);
+	GLState::BindTexture(GL_TEXTURE_2D, texture.get());
+	glTexStorage2D(GL_TEXTURE_2D, 1, format, m_width, m_height);
+	// The lighting pass reads exactly one texel per pixel.
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GLState::BindTexture(GL_TEXTURE_2D, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture.get(), 0);
+}
+
+void GBuffer::release()
+{
+	m_framebuffer.reset();
+	m_albedo.reset();
+	m_normal.reset();
+	m_depth.reset();
+	m_screenVao.reset();
+	m_width = m_height = 0;
+}
+
+void GBuffer::bindForGeometry()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer.get());
+	glViewport(0, 0, m_width, m_height);
+	// Depth 1 marks pixels no geometry covered, which the lighting pass discards.
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void GBuffer::bindForLighting()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLState::BindTextureUnit(GL_TEXTURE0 + GBUFFER_ALBEDO_UNIT, GL_TEXTURE_2D, m_albedo.get());
+	GLState::BindTextureUnit(GL_TEXTURE0 + GBUFFER_NORMAL_UNIT, GL_TEXTURE_2D, m_normal.get());
+	GLState::BindTextureUnit(GL_TEXTURE0 + GBUFFER_DEPTH_UNIT, GL_TEXTURE_2D, m_depth.get());
+}
+
+void GBuffer::unbindTextures()
+{
+	for (GLenum unit : { GBUFFER_ALBEDO_UNIT, GBUFFER_NORMAL_UNIT, GBUFFER_DEPTH_UNIT })
+		GLState::BindTextureUnit(GL_TEXTURE0 + unit, GL_TEXTURE_2D, 0);
+}
+
+void GBuffer::drawFullscreen()
+{
+	GLState::BindVertexArray(m_screenVao.get());
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	Shape::DrawCount()++;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "GLHandle.h"
+
+// Texture units the lighting pass in deferred.frag samples the G-buffer from. Match the sampler bindings there.
+#define GBUFFER_ALBEDO_UNIT 1
+#define GBUFFER_NORMAL_UNIT 2
+#define GBUFFER_DEPTH_UNIT 3
+
+// Off-screen targets for deferred shading. The geometry pass writes surface albedo and world normals, with the
+// material's specular strength and shininess in their alpha. The lighting pass rebuilds each pixel's position
+// from the depth buffer instead of storing it.
+class GBuffer
+{
+public:
+	// Allocates every target at the given size. Calling it again with the same size does nothing.
+	void resize(int width, int height);
+	void release();
+
+	// Makes the G-buffer the draw target and clears it.
+	void bindForGeometry();
+	// Goes back to the window and binds the targets to their GBUFFER_*_UNIT texture units.
+	void bindForLighting();
+	// Unbinds the targets again, so the next geometry pass never writes a texture that is still bound for sampling.
+	void unbindTextures();
+	// One triangle covering the screen. Its corners come from gl_VertexID in deferred.vert.
+	void drawFullscreen();
+
+	int width() const { return m_width; }
+	int height() const { return m_height; }
+	// Bytes the targets take in GPU memory, and so roughly what the geometry pass writes per frame.
+	size_t byteSize() const { return (size_t)m_width * m_height * (4 + 8 + 4); }
+
+private:
+	void allocate(GLTexture& texture, GLenum format, GLenum attachment);
+
+	int m_width = 0, m_height = 0;
+	GLFramebuffer m_framebuffer;
+	GLTexture m_albedo; // RGBA8: texture color times vertex color.
+	GLTexture m_normal; // RGBA16F: world normal, alpha unused.
+	GLTexture m_depth; // 32-bit float depth.
+	GLVertexArray m_screenVao; // Empty, but core profile still needs one bound to draw.
+
+};
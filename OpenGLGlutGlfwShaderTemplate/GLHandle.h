@@ -0,0 +1,102 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "GLState.h"
+
+// Number of GL objects currently owned by GLHandles, across all types. Should be 0 after teardown.
+inline int& LiveGLObjects()
+{
+	static int count = 0;
+	return count;
+}
+
+struct BufferTraits
+{
+	static GLuint Create() { GLuint id = 0; glGenBuffers(1, &id); return id; }
+	static void Destroy(GLuint id) { GLState::ForgetBuffer(id); glDeleteBuffers(1, &id); }
+};
+
+struct VertexArrayTraits
+{
+	static GLuint Create() { GLuint id = 0; glGenVertexArrays(1, &id); return id; }
+	static void Destroy(GLuint id) { GLState::ForgetVertexArray(id); glDeleteVertexArrays(1, &id); }
+};
+
+struct TextureTraits
+{
+	static GLuint Create() { GLuint id = 0; glGenTextures(1, &id); return id; }
+	static void Destroy(GLuint id) { GLState::ForgetTexture(id); glDeleteTextures(1, &id); }
+};
+
+struct ProgramTraits
+{
+	static GLuint Create() { return glCreateProgram(); }
+	static void Destroy(GLuint id) { GLState::ForgetProgram(id); glDeleteProgram(id); }
+};
+
+struct FramebufferTraits
+{
+	static GLuint Create() { GLuint id = 0; glGenFramebuffers(1, &id); return id; }
+	static void Destroy(GLuint id) { glDeleteFramebuffers(1, &id); }
+};
+
+struct QueryTraits
+{
+	static GLuint Create() { GLuint id = 0; glGenQueries(1, &id); return id; }
+	static void Destroy(GLuint id) { glDeleteQueries(1, &id); }
+};
+
+// Move-only owner of one GL object. The object is deleted when the handle is destroyed or reset,
+// so copies can no longer end up sharing (and double-freeing or leaking) the same name.
+template <typename Traits>
+class GLHandle
+{
+public:
+	GLHandle() {}
+	~GLHandle() { reset(); }
+	GLHandle(const GLHandle&) = delete;
+	GLHandle& operator=(const GLHandle&) = delete;
+	GLHandle(GLHandle&& other) : m_id(other.m_id) { other.m_id = 0; }
+	GLHandle& operator=(GLHandle&& other)
+	{
+		if (this != &other)
+		{
+			reset();
+			m_id = other.m_id;
+			other.m_id = 0;
+		}
+		return *this;
+	}
+
+	static GLHandle create()
+	{
+		GLHandle handle;
+		handle.m_id = Traits::Create();
+		if (handle.m_id != 0)
+			LiveGLObjects()++;
+		return handle;
+	}
+
+	void reset()
+	{
+		if (m_id == 0)
+			return;
+		Traits::Destroy(m_id);
+		LiveGLObjects()--;
+		m_id = 0;
+	}
+
+	GLuint get() const { return m_id; }
+	explicit operator bool() const { return m_id != 0; }
+
+private:
+	GLuint m_id = 0;
+};
+
+typedef GLHandle<BufferTraits> GLBuffer;
+typedef GLHandle<VertexArrayTraits> GLVertexArray;
+typedef GLHandle<TextureTraits> GLTexture;
+typedef GLHandle<ProgramTraits> GLProgram;
+typedef GLHandle<FramebufferTraits> GLFramebuffer;
+typedef GLHandle<QueryTraits> GLQuery;
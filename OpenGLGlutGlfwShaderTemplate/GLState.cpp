@@ -0,0 +1,215 @@
+#include "GLState.h"
+
+// Held by any binding whose GL value isn't known, so the next call always goes through.
+static const GLuint UNKNOWN = ~0u;
+
+static const GLenum BUFFER_TARGETS[] = { GL_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_SHADER_STORAGE_BUFFER, GL_DRAW_INDIRECT_BUFFER,
+	GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER };
+static const int BUFFER_TARGET_COUNT = sizeof(BUFFER_TARGETS) / sizeof(BUFFER_TARGETS[0]);
+static const GLenum TEXTURE_TARGETS[] = { GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY };
+static const int TEXTURE_TARGET_COUNT = sizeof(TEXTURE_TARGETS) / sizeof(TEXTURE_TARGETS[0]);
+static const GLenum CAPABILITIES[] = { GL_DEPTH_TEST, GL_CULL_FACE, GL_BLEND, GL_POLYGON_OFFSET_FILL, GL_LINE_SMOOTH, GL_POLYGON_SMOOTH };
+static const int CAPABILITY_COUNT = sizeof(CAPABILITIES) / sizeof(CAPABILITIES[0]);
+
+struct CachedState
+{
+	GLuint program;
+	GLuint vao;
+	GLuint buffers[BUFFER_TARGET_COUNT];
+	GLenum activeUnit;
+	GLuint textures[GL_STATE_TEXTURE_UNITS][TEXTURE_TARGET_COUNT];
+	GLuint capabilities[CAPABILITY_COUNT]; // GL_TRUE, GL_FALSE or UNKNOWN.
+};
+
+static CachedState unknownState()
+{
+	CachedState state;
+	state.program = UNKNOWN;
+	state.vao = UNKNOWN;
+	for (GLuint& bound : state.buffers)
+		bound = UNKNOWN;
+	state.activeUnit = UNKNOWN;
+	for (auto& unit : state.textures)
+	{
+		for (GLuint& bound : unit)
+			bound = UNKNOWN;
+	}
+	for (GLuint& enabled : state.capabilities)
+		enabled = UNKNOWN;
+	return state;
+}
+
+static CachedState& cache()
+{
+	static CachedState state = unknownState();
+	return state;
+}
+
+// Index of value in a target table, or -1 if it is not tracked.
+static int find(const GLenum* table, int count, GLenum value)
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (table[i] == value)
+			return i;
+	}
+	return -1;
+}
+
+// Points a cached value at value. Returns false, and counts a skipped call, if it already was.
+static bool change(GLuint& cached, GLuint value)
+{
+	if (cached == value)
+	{
+		GLState::SkippedCount()++;
+		return false;
+	}
+	cached = value;
+	GLState::IssuedCount()++;
+	return true;
+}
+
+void GLState::UseProgram(GLuint program)
+{
+	if (change(cache().program, program))
+		glUseProgram(program);
+}
+
+void GLState::BindVertexArray(GLuint vao)
+{
+	if (change(cache().vao, vao))
+		glBindVertexArray(vao);
+}
+
+void GLState::BindBuffer(GLenum target, GLuint buffer)
+{
+	int index = find(BUFFER_TARGETS, BUFFER_TARGET_COUNT, target);
+	if (index < 0)
+	{
+		IssuedCount()++;
+		glBindBuffer(target, buffer);
+		return;
+	}
+	if (change(cache().buffers[index], buffer))
+		glBindBuffer(target, buffer);
+}
+
+void GLState::BindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+	IssuedCount()++;
+	glBindBufferBase(target, index, buffer);
+	int slot = find(BUFFER_TARGETS, BUFFER_TARGET_COUNT, target);
+	if (slot >= 0)
+		cache().buffers[slot] = buffer;
+}
+
+void GLState::BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+	IssuedCount()++;
+	glBindBufferRange(target, index, buffer, offset, size);
+	int slot = find(BUFFER_TARGETS, BUFFER_TARGET_COUNT, target);
+	if (slot >= 0)
+		cache().buffers[slot] = buffer;
+}
+
+void GLState::ActiveTexture(GLenum unit)
+{
+	if (change(cache().activeUnit, unit))
+		glActiveTexture(unit);
+}
+
+void GLState::BindTexture(GLenum target, GLuint texture)
+{
+	CachedState& state = cache();
+	GLuint unit = state.activeUnit - GL_TEXTURE0;
+	int index = find(TEXTURE_TARGETS, TEXTURE_TARGET_COUNT, target);
+	if (state.activeUnit == UNKNOWN || unit >= GL_STATE_TEXTURE_UNITS || index < 0)
+	{
+		IssuedCount()++;
+		glBindTexture(target, texture);
+		// The unit is unknown, so whatever was remembered for target anywhere might be stale.
+		if (index >= 0 && state.activeUnit == UNKNOWN)
+		{
+			for (int i = 0; i < GL_STATE_TEXTURE_UNITS; i++)
+				state.textures[i][index] = UNKNOWN;
+		}
+		return;
+	}
+	if (change(state.textures[unit][index], texture))
+		glBindTexture(target, texture);
+}
+
+void GLState::BindTextureUnit(GLenum unit, GLenum target, GLuint texture)
+{
+	CachedState& state = cache();
+	GLuint slot = unit - GL_TEXTURE0;
+	int index = find(TEXTURE_TARGETS, TEXTURE_TARGET_COUNT, target);
+	if (slot < GL_STATE_TEXTURE_UNITS && index >= 0 && state.textures[slot][index] == texture)
+	{
+		SkippedCount()++;
+		return;
+	}
+	ActiveTexture(unit);
+	BindTexture(target, texture);
+}
+
+static void setCapability(GLenum cap, GLuint enabled)
+{
+	int index = find(CAPABILITIES, CAPABILITY_COUNT, cap);
+	if (index >= 0 && !change(cache().capabilities[index], enabled))
+		return;
+	if (index < 0)
+		GLState::IssuedCount()++;
+	if (enabled == GL_TRUE)
+		glEnable(cap);
+	else
+		glDisable(cap);
+}
+
+void GLState::Enable(GLenum cap)
+{
+	setCapability(cap, GL_TRUE);
+}
+
+void GLState::Disable(GLenum cap)
+{
+	setCapability(cap, GL_FALSE);
+}
+
+void GLState::ForgetProgram(GLuint program)
+{
+	if (cache().program == program)
+		cache().program = UNKNOWN;
+}
+
+void GLState::ForgetVertexArray(GLuint vao)
+{
+	if (cache().vao == vao)
+		cache().vao = UNKNOWN;
+}
+
+void GLState::ForgetBuffer(GLuint buffer)
+{
+	for (GLuint& bound : cache().buffers)
+	{
+		if (bound == buffer)
+			bound = UNKNOWN;
+	}
+}
+
+void GLState::ForgetTexture(GLuint texture)
+{
+	for (auto& unit : cache().textures)
+	{
+		for (GLuint& bound : unit)
+		{
+			if (bound == texture)
+				bound = UNKNOWN;
+		}
+	}
+}
+
+void GLState::Invalidate()
+{
+	cache() = unknownState();
+}
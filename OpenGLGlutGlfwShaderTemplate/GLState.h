@@ -0,0 +1,49 @@
+#pragma once
+
+#include <GL/glew.h>
+
+// Texture units and targets whose bindings are tracked. Binds outside them are always issued.
+#define GL_STATE_TEXTURE_UNITS 16
+
+// Remembers the last program, vertex array, buffer, texture and capability set through it, and drops
+// calls that would set what is already set. Every bind in the project goes through here, so the cache
+// can trust that nothing changed behind its back; GLHandle tells it when a tracked object is deleted.
+// Element array bindings belong to the vertex array, so those are always issued.
+class GLState
+{
+public:
+	// GL calls issued and skipped since the counters were last reset. display() resets them every frame.
+	static GLuint& IssuedCount()
+	{
+		static GLuint count = 0;
+		return count;
+	}
+	static GLuint& SkippedCount()
+	{
+		static GLuint count = 0;
+		return count;
+	}
+
+	static void UseProgram(GLuint program);
+	static void BindVertexArray(GLuint vao);
+	static void BindBuffer(GLenum target, GLuint buffer);
+	// Indexed binds are always issued, but they also set the generic binding of target, so that is tracked.
+	static void BindBufferBase(GLenum target, GLuint index, GLuint buffer);
+	static void BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+	// Same meaning as glActiveTexture and glBindTexture, so code that edits the bound texture keeps working.
+	static void ActiveTexture(GLenum unit);
+	static void BindTexture(GLenum target, GLuint texture);
+	// Binds texture to unit for sampling. Only switches the active unit if the bind is needed, so afterwards
+	// any unit may be active; code that edits a texture must make its unit active with ActiveTexture first.
+	static void BindTextureUnit(GLenum unit, GLenum target, GLuint texture);
+	static void Enable(GLenum cap);
+	static void Disable(GLenum cap);
+
+	// Called by GLHandle before the object is deleted. GL unbinds deleted objects, so whatever held them goes unknown.
+	static void ForgetProgram(GLuint program);
+	static void ForgetVertexArray(GLuint vao);
+	static void ForgetBuffer(GLuint buffer);
+	static void ForgetTexture(GLuint texture);
+	// Forgets everything, for code that changed GL state without going through here.
+	static void Invalidate();
+};
@@ -0,0 +1,62 @@
+#include "GpuTimer.h"
+
+void GpuTimer::create()
+{
+	for (GLQuery& query : m_queries)
+		query = GLQuery::create();
+	m_next = m_pending = m_stale = 0;
+	restart();
+}
+
+void GpuTimer::release()
+{
+	for (GLQuery& query : m_queries)
+		query.reset();
+	m_pending = m_stale = 0;
+}
+
+void GpuTimer::begin()
+{
+	// Every query is still in flight, so the oldest has to be waited for before it can be reused.
+	if (m_pending == QUERY_COUNT)
+		collect(true);
+	glBeginQuery(GL_TIME_ELAPSED, m_queries[m_next].get());
+}
+
+void GpuTimer::end()
+{
+	glEndQuery(GL_TIME_ELAPSED);
+	m_next = (m_next + 1) % QUERY_COUNT;
+	m_pending++;
+	collect(false);
+}
+
+void GpuTimer::restart()
+{
+	m_stale = m_pending;
+	m_frames = 0;
+	m_totalNs = 0.0;
+}
+
+void GpuTimer::collect(bool wait)
+{
+	while (m_pending > 0)
+	{
+		GLuint query = m_queries[(m_next - m_pending + QUERY_COUNT) % QUERY_COUNT].get();
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available && !wait)
+			return;
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+		m_pending--;
+		wait = false;
+		if (m_stale > 0)
+		{
+			m_stale--;
+			continue;
+		}
+		m_frames++;
+		m_totalNs += (double)elapsed;
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "GLHandle.h"
+
+// Measures GPU time per frame with GL_TIME_ELAPSED queries. Results are read a few frames late,
+// so timing never stalls the CPU waiting for the GPU to catch up.
+class GpuTimer
+{
+public:
+	void create();
+	void release();
+
+	// Bracket everything the frame draws. Only one begin/end pair may be open at a time.
+	void begin();
+	void end();
+	// Drops every result so far, including frames still in flight. Call it when what is being drawn changes.
+	void restart();
+
+	// Frames read back since the last restart, and their mean GPU time.
+	int frames() const { return m_frames; }
+	double averageMs() const { return m_frames == 0 ? 0.0 : m_totalNs / 1e6 / m_frames; }
+
+private:
+	// Reads finished queries, oldest first. With wait set it blocks on the oldest one.
+	void collect(bool wait);
+
+	static const int QUERY_COUNT = 4;
+	GLQuery m_queries[QUERY_COUNT];
+	int m_next = 0;
+	int m_pending = 0;
+	// In-flight queries issued before the last restart, whose results are thrown away.
+	int m_stale = 0;
+	int m_frames = 0;
+	double m_totalNs = 0.0;
+
+};
@@ -0,0 +1,196 @@
+#include "IndirectScene.h"
+#include "LightAssignment.h"
+
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+
+void IndirectScene::add(MazeShape& group, glm::vec3 position, const Material* material)
+{
+	m_sources.push_back({ &group, position, nullptr, glm::mat4(1.0f), material, 0, 0 });
+}
+
+void IndirectScene::add(const Shape& shape, const glm::mat4& model, const Material* material)
+{
+	m_sources.push_back({ nullptr, glm::vec3(0.0f), &shape, model, material, 1, 0 });
+}
+
+void IndirectScene::build()
+{
+	// One draw per entry, sorted so each material's entries are contiguous and, within it, each mesh's.
+	struct Draw
+	{
+		int material;
+		const Shape* mesh;
+		Record record;
+	};
+	std::vector<const Material*> materials;
+	std::vector<Draw> draws;
+	for (int i = 0; i < m_sources.size(); i++)
+	{
+		Source& source = m_sources[i];
+		int material = std::find(materials.begin(), materials.end(), source.material) - materials.begin();
+		if (material == materials.size())
+			materials.push_back(source.material);
+		if (source.group == nullptr)
+		{
+			draws.push_back({ material, source.shape, { i, -1 } });
+			continue;
+		}
+		source.version = source.group->refresh(source.position);
+		source.size = source.group->size();
+		for (int entry = 0; entry < source.size; entry++)
+			draws.push_back({ material, &source.group->getShape(entry), { i, entry } });
+	}
+	std::stable_sort(draws.begin(), draws.end(), [](const Draw& a, const Draw& b) {
+		return a.material != b.material ? a.material < b.material : a.mesh < b.mesh;
+	});
+
+	// Meshes shared by several groups, like the registry's cubes, go into the arena once.
+	m_arena.reset(new MeshArena());
+	std::unordered_map<const Shape*, MeshArena::Range> ranges;
+	std::vector<DrawElementsIndirectCommand> commands;
+	m_records.clear();
+	m_batches.clear();
+	for (size_t i = 0; i < draws.size(); i++)
+	{
+		const Draw& draw = draws[i];
+		auto range = ranges.find(draw.mesh);
+		if (range == ranges.end())
+			range = ranges.emplace(draw.mesh, m_arena->Add(*draw.mesh)).first;
+		bool newBatch = i == 0 || draws[i - 1].material != draw.material;
+		if (newBatch)
+		{
+			const Aabb empty = { glm::vec3(0.0f), glm::vec3(0.0f) };
+			m_batches.push_back({ materials[draw.material], (GLintptr)(commands.size() * sizeof(DrawElementsIndirectCommand)), 0, i, 0, empty });
+		}
+		// Entries sharing a mesh are instances of one command, and their records follow each other from baseInstance on.
+		if (newBatch || draws[i - 1].mesh != draw.mesh)
+		{
+			commands.push_back({ range->second.indexCount, 0, range->second.firstIndex, range->second.baseVertex, (GLuint)i });
+			m_batches.back().count++;
+		}
+		commands.back().instanceCount++;
+		m_batches.back().recordCount++;
+		m_records.push_back(draw.record);
+	}
+	if (commands.empty())
+	{
+		std::cout << "IndirectScene has nothing to draw!!! " << std::endl;
+		m_arena.reset();
+		return;
+	}
+	m_arena->BufferShape();
+	m_arena->BufferDrawIndices(m_records.size());
+
+	if (!m_commandBuffer)
+	{
+		m_commandBuffer = GLBuffer::create();
+		m_drawBuffer = GLBuffer::create();
+		Shape::BufferCount() += 2;
+	}
+	size_t commandBytes = commands.size() * sizeof(DrawElementsIndirectCommand);
+	GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer.get());
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, commandBytes, commands.data(), GL_STATIC_DRAW);
+	GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	Shape::UploadedBytes() += commandBytes;
+
+	m_drawData.resize(m_records.size());
+	writeRecords();
+}
+
+bool IndirectScene::updateSources()
+{
+	bool changed = false;
+	for (Source& source : m_sources)
+	{
+		if (source.group == nullptr)
+			continue;
+		unsigned version = source.group->refresh(source.position);
+		changed |= version != source.version;
+		source.version = version;
+	}
+	if (m_lights != nullptr && m_spots != nullptr && m_lightBuffer != nullptr && m_lightBuffer->version() != m_lightVersion)
+		changed = true;
+	return changed;
+}
+
+void IndirectScene::writeRecords()
+{
+	bool assignLights = m_lights != nullptr && m_spots != nullptr && m_lightBuffer != nullptr;
+	if (assignLights)
+		m_lightVersion = m_lightBuffer->version();
+	for (Batch& batch : m_batches)
+	{
+		for (size_t record = batch.firstRecord; record < batch.firstRecord + batch.recordCount; record++)
+		{
+			const Record& ref = m_records[record];
+			const Source& source = m_sources[ref.source];
+			GpuDrawData& data = m_drawData[record];
+			Aabb bounds;
+			if (source.group != nullptr)
+			{
+				const MazeShape& group = *source.group;
+				data.model = group.worldMatrix(ref.entry);
+				data.normalMatrix = glm::mat4(group.normalMatrix(ref.entry));
+				data.tint = glm::vec4(group.getTint(ref.entry), 1.0f);
+				data.lights = group.getLights(ref.entry);
+				bounds = group.worldBounds(ref.entry);
+			}
+			else
+			{
+				data.model = source.model;
+				data.normalMatrix = glm::mat4(NormalMatrix(source.model));
+				data.tint = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+				bounds = TransformBounds(source.shape->Bounds(), source.model);
+				data.lights = assignLights ? AssignLights(bounds, *m_lights, *m_spots) : NO_OBJECT_LIGHTS;
+			}
+			bool first = record == batch.firstRecord;
+			batch.bounds.min = first ? bounds.min : glm::min(batch.bounds.min, bounds.min);
+			batch.bounds.max = first ? bounds.max : glm::max(batch.bounds.max, bounds.max);
+		}
+	}
+
+	// The whole buffer in one go. It only happens when something in the maze moved or the lights changed.
+	size_t bytes = m_drawData.size() * sizeof(GpuDrawData);
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawBuffer.get());
+	glBufferData(GL_SHADER_STORAGE_BUFFER, bytes, m_drawData.data(), GL_DYNAMIC_DRAW);
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_DATA_BINDING, m_drawBuffer.get());
+	Shape::UploadedBytes() += bytes;
+}
+
+void IndirectScene::submit(DrawQueue& queue, unsigned pass)
+{
+	if (!m_arena)
+		return;
+	// A group that gained or lost entries needs new commands, not just new records.
+	for (const Source& source : m_sources)
+	{
+		if (source.group != nullptr && source.group->size() != source.size)
+		{
+			build();
+			break;
+		}
+	}
+	if (!m_arena)
+		return;
+	if (updateSources())
+		writeRecords();
+	for (const Batch& batch : m_batches)
+	{
+		queue.submit(pass, { batch.material, m_arena.get(), nullptr, nullptr, glm::vec3(1.0f, 1.0f, 1.0f), NO_OBJECT_LIGHTS,
+			0, 0, 0, (batch.bounds.min + batch.bounds.max) * 0.5f, m_commandBuffer.get(), batch.offset, batch.count });
+	}
+}
+
+void IndirectScene::clear()
+{
+	m_sources.clear();
+	m_records.clear();
+	m_drawData.clear();
+	m_batches.clear();
+	m_arena.reset();
+	m_commandBuffer.reset();
+	m_drawBuffer.reset();
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "DrawQueue.h"
+#include "GLHandle.h"
+#include "LightBuffer.h"
+#include "Material.h"
+#include "MazeShape.h"
+#include "Shape.h"
+
+// Shader storage binding of the Draws buffer in directional.vert and shadow.vert.
+#define DRAW_DATA_BINDING 4
+
+// std430 mirror of DrawData. The normal matrix takes a whole mat4 so no column needs padding by hand.
+struct GpuDrawData
+{
+	glm::mat4 model;
+	glm::mat4 normalMatrix;
+	glm::vec4 tint;
+	ObjectLights lights;
+};
+
+static_assert(sizeof(GpuDrawData) == 160, "GpuDrawData does not match std430");
+
+// What glMultiDrawElementsIndirect reads from the command buffer for each draw.
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+// Draws the maze through glMultiDrawElementsIndirect. Every mesh the groups use is copied once into a shared
+// MeshArena, every entry gets a DrawData record in a storage buffer, and each material's entries become one
+// run of commands, one per mesh, instanced over the entries using it. A frame then costs one multi-draw per
+// material and no uploads. The records are only rewritten when an entry or the lights change, and the
+// commands only when a group gains or loses entries.
+class IndirectScene
+{
+public:
+	// Assigns point and spot lights to the lone shapes for the per-object light mode. The groups bring their own.
+	void setLights(const std::vector<PointLight>* lights, const std::vector<SpotLight>* spots, const LightBuffer* lightBuffer) {
+		m_lights = lights;
+		m_spots = spots;
+		m_lightBuffer = lightBuffer;
+	}
+	// The group stays owned by the caller and is read again on every submit.
+	void add(MazeShape& group, glm::vec3 position, const Material* material);
+	void add(const Shape& shape, const glm::mat4& model, const Material* material);
+	// Builds the arena, the command buffer and the records. Call once after the last add.
+	void build();
+	// Queues one multi-draw per material for pass, after bringing the records up to date.
+	void submit(DrawQueue& queue, unsigned pass);
+	// Deletes the arena and the buffers, and forgets every group and shape.
+	void clear();
+
+private:
+	// A group, or a lone shape when group is nullptr.
+	struct Source
+	{
+		MazeShape* group;
+		glm::vec3 position;
+		const Shape* shape;
+		glm::mat4 model;
+		const Material* material;
+		int size; // Entries the commands were built for.
+		unsigned version; // Of the group when its records were last written.
+	};
+
+	// Where a record's values come from. entry is -1 for a lone shape.
+	struct Record
+	{
+		int source;
+		int entry;
+	};
+
+	// The commands of one material, and the records they read.
+	struct Batch
+	{
+		const Material* material;
+		GLintptr offset;
+		GLsizei count;
+		size_t firstRecord, recordCount;
+		Aabb bounds; // Around every entry of the batch, for the depth order.
+	};
+
+	bool updateSources();
+	void writeRecords();
+
+	const std::vector<PointLight>* m_lights = nullptr;
+	const std::vector<SpotLight>* m_spots = nullptr;
+	const LightBuffer* m_lightBuffer = nullptr;
+	unsigned m_lightVersion = 0;
+
+	std::vector<Source> m_sources;
+	// In command order, so the instances of a command find theirs at baseInstance onwards.
+	std::vector<Record> m_records;
+	std::vector<GpuDrawData> m_drawData;
+	std::vector<Batch> m_batches;
+	std::unique_ptr<MeshArena> m_arena;
+	GLBuffer m_commandBuffer;
+	GLBuffer m_drawBuffer;
+
+};
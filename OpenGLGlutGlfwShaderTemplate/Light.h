@@ -35,10 +35,12 @@ struct PointLight : public Light
 {
 	glm::vec3 position; //= glm::vec3(0.0f, 0.0f, 0.0f);
 	GLfloat constant, linear, quadratic;
+	GLfloat range; // Distance past which the light contributes nothing.
 	PointLight(glm::vec3 pos, GLfloat range, GLfloat con, GLfloat lin, GLfloat quad,
 		glm::vec3 dCol, GLfloat dStr) : Light(dCol, dStr)
 	{
 		position = pos;
+		this->range = range;
 		constant = con; //= 1.0f
 		linear = lin / range; //= 4.5f / range;
 		quadratic = quad / (range * range); //= 75.0f / (range * range);
@@ -48,20 +50,20 @@ struct PointLight : public Light
 struct SpotLight : public Light
 {
 	glm::vec3 position;
-	glm::vec3 direction;
-	GLfloat edge, edgeRad;
-	SpotLight(glm::vec3 pos, glm::vec3 dCol, GLfloat dStr, glm::vec3 dir,
-		GLfloat e) : Light(dCol, dStr)
+	glm::vec3 direction; // Unit length.
+	GLfloat edge, edgeRad; // Half angle of the cone in degrees, and its cosine.
+	GLfloat constant, linear, quadratic;
+	GLfloat range; // Distance past which the light contributes nothing, like PointLight::range.
+	SpotLight(glm::vec3 pos, GLfloat range, GLfloat con, GLfloat lin, GLfloat quad,
+		glm::vec3 dCol, GLfloat dStr, glm::vec3 dir, GLfloat e) : Light(dCol, dStr)
 	{
 		position = pos;
-		direction = dir;
+		direction = glm::normalize(dir);
 		edge = e;
 		edgeRad = cosf(glm::radians(edge));
+		this->range = range;
+		constant = con;
+		linear = lin / range;
+		quadratic = quad / (range * range);
 	}
 };
-
-struct Material
-{
-	GLfloat specularStrength;
-	GLfloat shininess;
-};
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <cmath>
+
+#include "LightAssignment.h"
+
+Aabb TransformBounds(const Aabb& local, const glm::mat4& model)
+{
+	Aabb world;
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec3 point((corner & 1) ? local.max.x : local.min.x,
+			(corner & 2) ? local.max.y : local.min.y,
+			(corner & 4) ? local.max.z : local.min.z);
+		point = glm::vec3(model * glm::vec4(point, 1.0f));
+		world.min = corner == 0 ? point : glm::min(world.min, point);
+		world.max = corner == 0 ? point : glm::max(world.max, point);
+	}
+	return world;
+}
+
+BoundingSphere SpotBounds(const SpotLight& light)
+{
+	// Wide cones are bounded by their cap, narrow ones by a sphere through the apex and the cap's rim.
+	float cosine = light.edgeRad;
+	if (cosine <= 0.0f)
+		return { light.position, light.range };
+	if (cosine < 0.70710678f)
+		return { light.position + light.direction * (light.range * cosine), light.range * sqrtf(1.0f - cosine * cosine) };
+	float radius = light.range / (2.0f * cosine);
+	return { light.position + light.direction * radius, radius };
+}
+
+bool SpotReachesBox(const SpotLight& light, const Aabb& box)
+{
+	glm::vec3 offset = light.position - glm::clamp(light.position, box.min, box.max);
+	if (glm::dot(offset, offset) >= light.range * light.range)
+		return false;
+	// Half angles of 90 degrees or more light a whole half space; the range test is all there is.
+	if (light.edgeRad <= 0.0f)
+		return true;
+
+	// Sphere against cone: distance from the sphere's center to the cone's side, measured perpendicular to the side.
+	glm::vec3 center = (box.min + box.max) * 0.5f;
+	float radius = glm::length(box.max - center);
+	glm::vec3 toCenter = center - light.position;
+	float along = glm::dot(toCenter, light.direction);
+	float across = sqrtf(std::max(glm::dot(toCenter, toCenter) - along * along, 0.0f));
+	float sine = sqrtf(std::max(1.0f - light.edgeRad * light.edgeRad, 0.0f));
+	float outside = light.edgeRad * across - sine * along;
+	return outside <= radius && along >= -radius;
+}
+
+namespace
+{
+	// The best lights so far, kept sorted by score, highest first.
+	struct Ranking
+	{
+		float scores[MAX_OBJECT_LIGHTS];
+		ObjectLights assigned = NO_OBJECT_LIGHTS;
+		int count = 0;
+
+		void offer(GLint index, float score)
+		{
+			if (count == MAX_OBJECT_LIGHTS && score <= scores[MAX_OBJECT_LIGHTS - 1])
+				return;
+			int slot = std::min(count, MAX_OBJECT_LIGHTS - 1);
+			while (slot > 0 && scores[slot - 1] < score)
+			{
+				scores[slot] = scores[slot - 1];
+				assigned.index[slot] = assigned.index[slot - 1];
+				slot--;
+			}
+			scores[slot] = score;
+			assigned.index[slot] = index;
+			count = std::min(count + 1, MAX_OBJECT_LIGHTS);
+		}
+	};
+
+	// Attenuated strength at the point of box closest to position, or 0 past range.
+	float score(const Light& light, glm::vec3 position, float range, float constant, float linear, float quadratic, const Aabb& box)
+	{
+		glm::vec3 offset = position - glm::clamp(position, box.min, box.max);
+		float distance2 = glm::dot(offset, offset);
+		if (distance2 >= range * range)
+			return 0.0f;
+		float distance = sqrtf(distance2);
+		return light.diffuseStrength / (constant + linear * distance + quadratic * distance2);
+	}
+}
+
+ObjectLights AssignLights(const Aabb& box, const std::vector<PointLight>& points, const std::vector<SpotLight>& spots)
+{
+	Ranking ranking;
+	for (GLint i = 0; i < (GLint)points.size(); i++)
+	{
+		const PointLight& light = points[i];
+		if (light.diffuseStrength <= 0.0f)
+			continue;
+		float lightScore = score(light, light.position, light.range, light.constant, light.linear, light.quadratic, box);
+		if (lightScore > 0.0f)
+			ranking.offer(i, lightScore);
+	}
+	for (GLint i = 0; i < (GLint)spots.size(); i++)
+	{
+		const SpotLight& light = spots[i];
+		if (light.diffuseStrength <= 0.0f || !SpotReachesBox(light, box))
+			continue;
+		float lightScore = score(light, light.position, light.range, light.constant, light.linear, light.quadratic, box);
+		if (lightScore > 0.0f)
+			ranking.offer((GLint)points.size() + i, lightScore);
+	}
+	return ranking.assigned;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Light.h"
+#include "Shape.h"
+
+struct BoundingSphere
+{
+	glm::vec3 center;
+	float radius;
+};
+
+// World-space box around a local box moved by model.
+Aabb TransformBounds(const Aabb& local, const glm::mat4& model);
+
+// Smallest sphere around the part of space a spot light reaches: its cone, cut off at its range.
+BoundingSphere SpotBounds(const SpotLight& light);
+
+// Whether any of box is inside the cone and range of light. Conservative: the cone is tested against
+// the sphere around the box, so a box just outside the cone's edge can still pass.
+bool SpotReachesBox(const SpotLight& light, const Aabb& box);
+
+// Picks the MAX_OBJECT_LIGHTS lights whose range reaches box and that light it the most, judged by their
+// attenuated strength at the closest point of the box. Spot lights must also pass SpotReachesBox.
+// Point lights are numbered first, then spot light i is points.size() + i. Unused slots are -1.
+ObjectLights AssignLights(const Aabb& box, const std::vector<PointLight>& points, const std::vector<SpotLight>& spots);
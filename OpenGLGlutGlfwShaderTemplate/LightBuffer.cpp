@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <cstring>
+
+#include "LightBuffer.h"
+#include "Shape.h"
+
+static GpuLight toGpu(const Light& light)
+{
+	GpuLight gpu;
+	gpu.diffuseColor = light.diffuseColor;
+	gpu.diffuseStrength = light.diffuseStrength;
+	return gpu;
+}
+
+void LightBuffer::create()
+{
+	m_buffer = GLBuffer::create();
+	GLState::BindBuffer(GL_UNIFORM_BUFFER, m_buffer.get());
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(GpuLightBlock), &m_block, GL_DYNAMIC_DRAW);
+	GLState::BindBuffer(GL_UNIFORM_BUFFER, 0);
+	GLState::BindBufferBase(GL_UNIFORM_BUFFER, LIGHT_BLOCK_BINDING, m_buffer.get());
+	Shape::BufferCount()++;
+	Shape::UploadedBytes() += sizeof(GpuLightBlock);
+	m_blockDirty = false;
+
+	m_points.buffer = GLBuffer::create();
+	m_spots.buffer = GLBuffer::create();
+	Shape::BufferCount() += 2;
+	allocate(m_points);
+	allocate(m_spots);
+}
+
+void LightBuffer::release()
+{
+	m_buffer.reset();
+	m_points.buffer.reset();
+	m_points.capacity = 0;
+	m_spots.buffer.reset();
+	m_spots.capacity = 0;
+}
+
+template <typename GpuType>
+void LightBuffer::allocate(LightArray<GpuType>& array)
+{
+	// Leave room to grow so adding a handful of lights doesn't reallocate every time. Never empty, so the binding stays valid.
+	array.capacity = std::max<size_t>(std::max<size_t>(array.lights.size(), array.capacity * 2), 1);
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, array.buffer.get());
+	glBufferData(GL_SHADER_STORAGE_BUFFER, array.capacity * sizeof(GpuType), nullptr, GL_DYNAMIC_DRAW);
+	if (!array.lights.empty())
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, array.lights.size() * sizeof(GpuType), array.lights.data());
+	GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	GLState::BindBufferBase(GL_SHADER_STORAGE_BUFFER, array.binding, array.buffer.get());
+	Shape::UploadedBytes() += array.lights.size() * sizeof(GpuType);
+	std::fill(array.dirty.begin(), array.dirty.end(), 0);
+}
+
+void LightBuffer::setAmbient(const AmbientLight& light)
+{
+	GpuAmbientLight gpu;
+	gpu.base = toGpu(light);
+	write(&m_block.aLight, &gpu, sizeof(gpu), m_blockDirty);
+}
+
+void LightBuffer::setDirectional(const DirectionalLight& light)
+{
+	GpuDirectionalLight gpu = {};
+	gpu.base = toGpu(light);
+	gpu.direction = light.direction;
+	write(&m_block.dLight, &gpu, sizeof(gpu), m_blockDirty);
+}
+
+template <typename GpuType>
+void LightBuffer::resize(LightArray<GpuType>& array, size_t count, GLuint& blockCount)
+{
+	if (count == array.lights.size())
+		return;
+	// New lights start zeroed and dirty, so they go up even if the caller never sets them.
+	array.lights.resize(count, GpuType());
+	array.dirty.resize(count, 1);
+	GLuint lightCount = (GLuint)count;
+	write(&blockCount, &lightCount, sizeof(lightCount), m_blockDirty);
+	m_version++;
+}
+
+template <typename GpuType>
+void LightBuffer::set(LightArray<GpuType>& array, size_t index, const GpuType& gpu)
+{
+	bool dirty = array.dirty[index] != 0;
+	if (memcmp(&array.lights[index], &gpu, sizeof(gpu)) != 0)
+		m_version++;
+	write(&array.lights[index], &gpu, sizeof(gpu), dirty);
+	array.dirty[index] = dirty;
+}
+
+void LightBuffer::setPointCount(size_t count)
+{
+	resize(m_points, count, m_block.pointLightCount);
+}
+
+void LightBuffer::setPoint(size_t index, const PointLight& light)
+{
+	GpuPointLight gpu = {};
+	gpu.base = toGpu(light);
+	gpu.position = light.position;
+	gpu.constant = light.constant;
+	gpu.linear = light.linear;
+	gpu.quadratic = light.quadratic;
+	gpu.range = light.range;
+	set(m_points, index, gpu);
+}
+
+void LightBuffer::setSpotCount(size_t count)
+{
+	resize(m_spots, count, m_block.spotLightCount);
+}
+
+void LightBuffer::setSpot(size_t index, const SpotLight& light)
+{
+	GpuSpotLight gpu = {};
+	gpu.base = toGpu(light);
+	gpu.position = light.position;
+	gpu.range = light.range;
+	gpu.direction = light.direction;
+	gpu.edge = light.edgeRad;
+	gpu.constant = light.constant;
+	gpu.linear = light.linear;
+	gpu.quadratic = light.quadratic;
+	set(m_spots, index, gpu);
+}
+
+void LightBuffer::write(void* target, const void* data, size_t size, bool& dirty)
+{
+	if (memcmp(target, data, size) == 0)
+		return;
+	memcpy(target, data, size);
+	dirty = true;
+}
+
+void LightBuffer::upload()
+{
+	if (!m_buffer)
+		return;
+	if (m_blockDirty)
+	{
+		GLState::BindBuffer(GL_UNIFORM_BUFFER, m_buffer.get());
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(GpuLightBlock), &m_block);
+		GLState::BindBuffer(GL_UNIFORM_BUFFER, 0);
+		Shape::UploadedBytes() += sizeof(GpuLightBlock);
+		m_blockDirty = false;
+	}
+	upload(m_points);
+	upload(m_spots);
+}
+
+template <typename GpuType>
+void LightBuffer::upload(LightArray<GpuType>& array)
+{
+	if (array.lights.size() > array.capacity)
+	{
+		allocate(array);
+		return;
+	}
+	bool bound = false;
+	for (size_t first = 0; first < array.lights.size(); first++)
+	{
+		if (!array.dirty[first])
+			continue;
+		// A run of dirty lights is one contiguous range.
+		size_t last = first;
+		while (last + 1 < array.lights.size() && array.dirty[last + 1])
+			last++;
+		if (!bound)
+		{
+			GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, array.buffer.get());
+			bound = true;
+		}
+		size_t size = (last - first + 1) * sizeof(GpuType);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, first * sizeof(GpuType), size, &array.lights[first]);
+		Shape::UploadedBytes() += size;
+		std::fill(array.dirty.begin() + first, array.dirty.begin() + last + 1, 0);
+		first = last;
+	}
+	if (bound)
+		GLState::BindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+#include "GLHandle.h"
+#include "Light.h"
+
+// Uniform block binding of the Lights block in lighting.glsl.
+#define LIGHT_BLOCK_BINDING 0
+// Shader storage bindings of the PointLights and SpotLights buffers in lighting.glsl.
+#define POINT_LIGHT_BINDING 0
+#define SPOT_LIGHT_BINDING 3
+
+// std140/std430 mirrors of the light structs in lighting.glsl. vec3 takes 16 bytes unless a float follows it,
+// and every struct is padded to a multiple of 16.
+struct GpuLight
+{
+	glm::vec3 diffuseColor;
+	GLfloat diffuseStrength;
+};
+
+struct GpuAmbientLight
+{
+	GpuLight base;
+};
+
+struct GpuDirectionalLight
+{
+	GpuLight base;
+	glm::vec3 direction;
+	GLfloat pad;
+};
+
+struct GpuPointLight
+{
+	GpuLight base;
+	glm::vec3 position;
+	GLfloat constant;
+	GLfloat linear;
+	GLfloat quadratic;
+	GLfloat range;
+	GLfloat pad;
+};
+
+struct GpuSpotLight
+{
+	GpuLight base;
+	glm::vec3 position;
+	GLfloat range;
+	glm::vec3 direction;
+	GLfloat edge; // Cosine of the half angle.
+	GLfloat constant;
+	GLfloat linear;
+	GLfloat quadratic;
+	GLfloat pad;
+};
+
+struct GpuLightBlock
+{
+	GpuAmbientLight aLight;
+	GpuDirectionalLight dLight;
+	GLuint pointLightCount;
+	GLuint spotLightCount;
+	GLuint pad[2];
+};
+
+static_assert(sizeof(GpuLight) == 16, "GpuLight does not match std140");
+static_assert(sizeof(GpuDirectionalLight) == 32, "GpuDirectionalLight does not match std140");
+static_assert(sizeof(GpuPointLight) == 48, "GpuPointLight does not match std430");
+static_assert(sizeof(GpuSpotLight) == 64, "GpuSpotLight does not match std430");
+static_assert(offsetof(GpuLightBlock, dLight) == 16 && offsetof(GpuLightBlock, pointLightCount) == 48, "GpuLightBlock does not match std140");
+
+// Keeps CPU copies of the Lights uniform block and the PointLights and SpotLights storage buffers,
+// and only re-uploads the lights that changed.
+class LightBuffer
+{
+public:
+	LightBuffer()
+	{
+		m_points.binding = POINT_LIGHT_BINDING;
+		m_spots.binding = SPOT_LIGHT_BINDING;
+	}
+
+	// Allocates every buffer with the current contents and binds them.
+	void create();
+	void release();
+
+	// Setters compare against the CPU copy, so calling them with an unchanged light is free.
+	void setAmbient(const AmbientLight& light);
+	void setDirectional(const DirectionalLight& light);
+	void setPointCount(size_t count);
+	void setPoint(size_t index, const PointLight& light);
+	size_t pointCount() const { return m_points.lights.size(); }
+	void setSpotCount(size_t count);
+	void setSpot(size_t index, const SpotLight& light);
+	size_t spotCount() const { return m_spots.lights.size(); }
+	// Bumped whenever a point or spot light changes, so anything built from the lights knows when to rebuild.
+	unsigned version() const { return m_version; }
+
+	// Sends every dirty light with one glBufferSubData per run of adjacent dirty lights.
+	// Grows a storage buffer first if its lights no longer fit.
+	void upload();
+
+private:
+	// One storage buffer of lights plus its CPU copy.
+	template <typename GpuType>
+	struct LightArray
+	{
+		std::vector<GpuType> lights;
+		std::vector<char> dirty;
+		size_t capacity = 0;
+		GLuint binding = 0;
+		GLBuffer buffer;
+	};
+
+	void write(void* target, const void* data, size_t size, bool& dirty);
+	template <typename GpuType>
+	void resize(LightArray<GpuType>& array, size_t count, GLuint& blockCount);
+	template <typename GpuType>
+	void set(LightArray<GpuType>& array, size_t index, const GpuType& gpu);
+	template <typename GpuType>
+	void allocate(LightArray<GpuType>& array);
+	template <typename GpuType>
+	void upload(LightArray<GpuType>& array);
+
+	GpuLightBlock m_block = {};
+	bool m_blockDirty = false;
+	LightArray<GpuPointLight> m_points;
+	LightArray<GpuSpotLight> m_spots;
+	unsigned m_version = 0;
+	GLBuffer m_buffer;
+
+};
@@ -0,0 +1,523 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
+
+#include "LightmapBaker.h"
+
+// Empty texels around each chart. Dilation fills DILATE_PASSES of them, and bilinear filtering reads one,
+// so neighbouring charts never bleed into each other.
+static const int CHART_PADDING = 2;
+static const int DILATE_PASSES = 2;
+// How far shadow rays start off the surface, in world units.
+static const float RAY_OFFSET = 0.01f;
+static const unsigned BVH_LEAF_SIZE = 4;
+
+// Triangles of one mesh that lie in the same plane and share vertices. Unwrapped by projecting onto that plane.
+struct Chart
+{
+	unsigned mesh;
+	std::vector<unsigned> triangles;
+	glm::vec3 u, v; // Plane axes.
+	glm::vec2 min, max; // Extent along them.
+	int x, y, width, height; // Place in the atlas, padding included.
+};
+
+static glm::vec3 FaceNormal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+{
+	glm::vec3 normal = glm::cross(b - a, c - a);
+	float length = glm::length(normal);
+	return length > 1e-12f ? normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+}
+
+static unsigned FindRoot(std::vector<unsigned>& parent, unsigned i)
+{
+	while (parent[i] != i)
+	{
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+	return i;
+}
+
+// Splits a mesh into charts: triangles join a chart when they share a vertex and a plane.
+static void FindCharts(const LightmapMesh& mesh, unsigned meshIndex, std::vector<Chart>& charts)
+{
+	unsigned triangleCount = mesh.indices.size() / 3;
+	std::map<std::array<int, 4>, unsigned> planes;
+	std::vector<unsigned> trianglePlane(triangleCount);
+	std::vector<glm::vec3> planeNormals;
+	for (unsigned t = 0; t < triangleCount; t++)
+	{
+		const glm::vec3& a = mesh.positions[mesh.indices[t * 3]];
+		glm::vec3 normal = FaceNormal(a, mesh.positions[mesh.indices[t * 3 + 1]], mesh.positions[mesh.indices[t * 3 + 2]]);
+		std::array<int, 4> key = { (int)roundf(normal.x * 1000.0f), (int)roundf(normal.y * 1000.0f),
+			(int)roundf(normal.z * 1000.0f), (int)roundf(glm::dot(normal, a) * 1000.0f) };
+		auto found = planes.insert({ key, (unsigned)planeNormals.size() });
+		if (found.second)
+			planeNormals.push_back(normal);
+		trianglePlane[t] = found.first->second;
+	}
+
+	std::vector<unsigned> parent(triangleCount);
+	std::iota(parent.begin(), parent.end(), 0u);
+	std::unordered_map<unsigned long long, unsigned> owner;
+	for (unsigned t = 0; t < triangleCount; t++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			unsigned long long key = ((unsigned long long)mesh.indices[t * 3 + k] << 32) | trianglePlane[t];
+			auto found = owner.insert({ key, t });
+			if (!found.second)
+				parent[FindRoot(parent, t)] = FindRoot(parent, found.first->second);
+		}
+	}
+
+	std::vector<int> chartOfRoot(triangleCount, -1);
+	for (unsigned t = 0; t < triangleCount; t++)
+	{
+		unsigned root = FindRoot(parent, t);
+		if (chartOfRoot[root] < 0)
+		{
+			chartOfRoot[root] = charts.size();
+			Chart chart = {};
+			chart.mesh = meshIndex;
+			glm::vec3 normal = planeNormals[trianglePlane[root]];
+			glm::vec3 helper = fabsf(normal.y) < 0.99f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+			chart.u = glm::normalize(glm::cross(helper, normal));
+			chart.v = glm::cross(normal, chart.u);
+			charts.push_back(chart);
+		}
+		charts[chartOfRoot[root]].triangles.push_back(t);
+	}
+}
+
+// Shelf packing, tallest charts first. False if they overflow the atlas.
+static bool PackCharts(std::vector<Chart>& charts, float texelsPerUnit, int size)
+{
+	for (Chart& chart : charts)
+	{
+		chart.width = (int)ceilf((chart.max.x - chart.min.x) * texelsPerUnit) + 1 + CHART_PADDING * 2;
+		chart.height = (int)ceilf((chart.max.y - chart.min.y) * texelsPerUnit) + 1 + CHART_PADDING * 2;
+	}
+	std::vector<Chart*> order;
+	for (Chart& chart : charts)
+		order.push_back(&chart);
+	std::sort(order.begin(), order.end(), [](const Chart* a, const Chart* b) { return a->height > b->height; });
+	int x = 0, y = 0, shelfHeight = 0;
+	for (Chart* chart : order)
+	{
+		if (chart->width > size)
+			return false;
+		if (x + chart->width > size)
+		{
+			x = 0;
+			y += shelfHeight;
+			shelfHeight = 0;
+		}
+		if (y + chart->height > size)
+			return false;
+		chart->x = x;
+		chart->y = y;
+		x += chart->width;
+		shelfHeight = std::max(shelfHeight, chart->height);
+	}
+	return true;
+}
+
+LightmapBaker::LightmapBaker(int size)
+	: m_size(size)
+{
+}
+
+void LightmapBaker::add(LightmapMesh* mesh)
+{
+	m_meshes.push_back(mesh);
+}
+
+bool LightmapBaker::unwrap()
+{
+	std::vector<Chart> charts;
+	for (unsigned m = 0; m < m_meshes.size(); m++)
+		FindCharts(*m_meshes[m], m, charts);
+	float area = 0.0f;
+	for (Chart& chart : charts)
+	{
+		const LightmapMesh& mesh = *m_meshes[chart.mesh];
+		chart.min = glm::vec2(INFINITY);
+		chart.max = glm::vec2(-INFINITY);
+		for (unsigned t : chart.triangles)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				const glm::vec3& p = mesh.positions[mesh.indices[t * 3 + k]];
+				glm::vec2 planar(glm::dot(p, chart.u), glm::dot(p, chart.v));
+				chart.min = glm::min(chart.min, planar);
+				chart.max = glm::max(chart.max, planar);
+			}
+		}
+		area += (chart.max.x - chart.min.x) * (chart.max.y - chart.min.y);
+	}
+
+	// Start from the density that would fill most of the atlas, and back off until everything fits.
+	m_texelsPerUnit = area > 0.0f ? sqrtf(0.8f * m_size * m_size / area) : 1.0f;
+	while (!PackCharts(charts, m_texelsPerUnit, m_size))
+	{
+		m_texelsPerUnit *= 0.9f;
+		if (m_texelsPerUnit < 1e-3f)
+			return false;
+	}
+	m_chartCount = charts.size();
+
+	// One vertex per (original vertex, chart) pair.
+	std::vector<std::vector<unsigned>> triangleChart(m_meshes.size());
+	for (unsigned m = 0; m < m_meshes.size(); m++)
+		triangleChart[m].resize(m_meshes[m]->indices.size() / 3);
+	for (unsigned c = 0; c < charts.size(); c++)
+	{
+		for (unsigned t : charts[c].triangles)
+			triangleChart[charts[c].mesh][t] = c;
+	}
+	m_triangles.clear();
+	for (unsigned m = 0; m < m_meshes.size(); m++)
+	{
+		LightmapMesh& mesh = *m_meshes[m];
+		std::vector<std::pair<unsigned, unsigned>> pairs;
+		for (unsigned i = 0; i < mesh.indices.size(); i++)
+			pairs.push_back({ mesh.indices[i], triangleChart[m][i / 3] });
+		std::sort(pairs.begin(), pairs.end());
+		pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+		mesh.remap.resize(pairs.size());
+		mesh.lightmapUvs.resize(pairs.size());
+		for (unsigned i = 0; i < pairs.size(); i++)
+		{
+			const Chart& chart = charts[pairs[i].second];
+			const glm::vec3& p = mesh.positions[pairs[i].first];
+			glm::vec2 planar(glm::dot(p, chart.u), glm::dot(p, chart.v));
+			glm::vec2 texel = glm::vec2((float)(chart.x + CHART_PADDING), (float)(chart.y + CHART_PADDING)) + (planar - chart.min) * m_texelsPerUnit;
+			mesh.remap[i] = pairs[i].first;
+			mesh.lightmapUvs[i] = texel / (float)m_size;
+		}
+		for (unsigned i = 0; i < mesh.indices.size(); i++)
+		{
+			std::pair<unsigned, unsigned> key(mesh.indices[i], triangleChart[m][i / 3]);
+			mesh.indices[i] = std::lower_bound(pairs.begin(), pairs.end(), key) - pairs.begin();
+		}
+
+		for (unsigned i = 0; i < mesh.indices.size(); i += 3)
+		{
+			Triangle triangle;
+			for (int k = 0; k < 3; k++)
+			{
+				unsigned vertex = mesh.indices[i + k];
+				triangle.position[k] = mesh.positions[mesh.remap[vertex]];
+				triangle.normal[k] = mesh.normals[mesh.remap[vertex]];
+				triangle.uv[k] = mesh.lightmapUvs[vertex];
+			}
+			m_triangles.push_back(triangle);
+		}
+	}
+	return true;
+}
+
+static float EdgeFunction(const glm::vec2& a, const glm::vec2& b, const glm::vec2& p)
+{
+	return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+}
+
+void LightmapBaker::rasterize(const Triangle& triangle)
+{
+	glm::vec2 t[3];
+	for (int k = 0; k < 3; k++)
+		t[k] = triangle.uv[k] * (float)m_size;
+	float area = EdgeFunction(t[0], t[1], t[2]);
+	if (fabsf(area) < 1e-8f)
+		return;
+	glm::vec3 faceNormal = FaceNormal(triangle.position[0], triangle.position[1], triangle.position[2]);
+	if (glm::dot(faceNormal, triangle.normal[0] + triangle.normal[1] + triangle.normal[2]) < 0.0f)
+		faceNormal = -faceNormal;
+
+	int minX = std::max((int)floorf(std::min(t[0].x, std::min(t[1].x, t[2].x))), 0);
+	int maxX = std::min((int)ceilf(std::max(t[0].x, std::max(t[1].x, t[2].x))), m_size - 1);
+	int minY = std::max((int)floorf(std::min(t[0].y, std::min(t[1].y, t[2].y))), 0);
+	int maxY = std::min((int)ceilf(std::max(t[0].y, std::max(t[1].y, t[2].y))), m_size - 1);
+	for (int y = minY; y <= maxY; y++)
+	{
+		for (int x = minX; x <= maxX; x++)
+		{
+			glm::vec2 center(x + 0.5f, y + 0.5f);
+			float w0 = EdgeFunction(t[1], t[2], center) / area;
+			float w1 = EdgeFunction(t[2], t[0], center) / area;
+			float w2 = 1.0f - w0 - w1;
+			// A little slack, so texel centers right on a shared edge are never missed by both triangles.
+			if (w0 < -1e-5f || w1 < -1e-5f || w2 < -1e-5f)
+				continue;
+			Sample& sample = m_samples[y * m_size + x];
+			sample.position = triangle.position[0] * w0 + triangle.position[1] * w1 + triangle.position[2] * w2;
+			sample.normal = glm::normalize(triangle.normal[0] * w0 + triangle.normal[1] * w1 + triangle.normal[2] * w2);
+			sample.faceNormal = faceNormal;
+			m_covered[y * m_size + x] = 1;
+		}
+	}
+}
+
+void LightmapBaker::buildBvh()
+{
+	m_order.resize(m_triangles.size());
+	std::iota(m_order.begin(), m_order.end(), 0u);
+	m_nodes.clear();
+	if (m_triangles.empty())
+		return;
+	m_nodes.push_back(BvhNode());
+	split(0, 0, m_order.size());
+}
+
+// Median split along the longest axis of the triangle centers.
+void LightmapBaker::split(unsigned node, unsigned first, unsigned count)
+{
+	glm::vec3 min(INFINITY), max(-INFINITY), centerMin(INFINITY), centerMax(-INFINITY);
+	for (unsigned i = first; i < first + count; i++)
+	{
+		const Triangle& triangle = m_triangles[m_order[i]];
+		for (int k = 0; k < 3; k++)
+		{
+			min = glm::min(min, triangle.position[k]);
+			max = glm::max(max, triangle.position[k]);
+		}
+		glm::vec3 center = (triangle.position[0] + triangle.position[1] + triangle.position[2]) / 3.0f;
+		centerMin = glm::min(centerMin, center);
+		centerMax = glm::max(centerMax, center);
+	}
+	m_nodes[node].min = min;
+	m_nodes[node].max = max;
+	if (count <= BVH_LEAF_SIZE)
+	{
+		m_nodes[node].first = first;
+		m_nodes[node].count = count;
+		return;
+	}
+
+	glm::vec3 extent = centerMax - centerMin;
+	int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+	const std::vector<Triangle>& triangles = m_triangles;
+	std::nth_element(m_order.begin() + first, m_order.begin() + first + count / 2, m_order.begin() + first + count,
+		[&triangles, axis](unsigned a, unsigned b) {
+			const Triangle& ta = triangles[a];
+			const Triangle& tb = triangles[b];
+			return ta.position[0][axis] + ta.position[1][axis] + ta.position[2][axis] <
+				tb.position[0][axis] + tb.position[1][axis] + tb.position[2][axis];
+		});
+	unsigned children = m_nodes.size();
+	m_nodes.push_back(BvhNode());
+	m_nodes.push_back(BvhNode());
+	m_nodes[node].first = children;
+	m_nodes[node].count = 0;
+	split(children, first, count / 2);
+	split(children + 1, first + count / 2, count - count / 2);
+}
+
+// Whether anything lies on the segment from origin to target.
+bool LightmapBaker::occluded(glm::vec3 origin, glm::vec3 target) const
+{
+	glm::vec3 direction = target - origin;
+	float maxT = 1.0f - 1e-4f;
+	unsigned stack[64];
+	int top = 0;
+	if (!m_nodes.empty())
+		stack[top++] = 0;
+	while (top > 0)
+	{
+		const BvhNode& node = m_nodes[stack[--top]];
+		// Slab test. fminf/fmaxf drop the NaN a zero direction component gives.
+		float tNear = 0.0f, tFar = maxT;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float inverse = 1.0f / direction[axis];
+			float t0 = (node.min[axis] - origin[axis]) * inverse;
+			float t1 = (node.max[axis] - origin[axis]) * inverse;
+			tNear = fmaxf(tNear, fminf(t0, t1));
+			tFar = fminf(tFar, fmaxf(t0, t1));
+		}
+		if (tNear > tFar)
+			continue;
+		if (node.count == 0)
+		{
+			stack[top++] = node.first;
+			stack[top++] = node.first + 1;
+			continue;
+		}
+		// Moller-Trumbore.
+		for (unsigned i = node.first; i < node.first + node.count; i++)
+		{
+			const Triangle& triangle = m_triangles[m_order[i]];
+			glm::vec3 edge1 = triangle.position[1] - triangle.position[0];
+			glm::vec3 edge2 = triangle.position[2] - triangle.position[0];
+			glm::vec3 p = glm::cross(direction, edge2);
+			float determinant = glm::dot(edge1, p);
+			if (fabsf(determinant) < 1e-12f)
+				continue;
+			float inverse = 1.0f / determinant;
+			glm::vec3 s = origin - triangle.position[0];
+			float u = glm::dot(s, p) * inverse;
+			if (u < 0.0f || u > 1.0f)
+				continue;
+			glm::vec3 q = glm::cross(s, edge1);
+			float v = glm::dot(direction, q) * inverse;
+			if (v < 0.0f || u + v > 1.0f)
+				continue;
+			float t = glm::dot(edge2, q) * inverse;
+			if (t > 0.0f && t < maxT)
+				return true;
+		}
+	}
+	return false;
+}
+
+float LightmapBaker::reach(const Sample& sample, glm::vec3 lightPosition, float range, float constant, float linear, float quadratic) const
+{
+	glm::vec3 toLight = lightPosition - sample.position;
+	float distance = glm::length(toLight);
+	if (distance >= range || distance <= 0.0f)
+		return 0.0f;
+	float lambert = glm::dot(sample.normal, toLight / distance);
+	if (lambert <= 0.0f)
+		return 0.0f;
+	if (occluded(sample.position + sample.faceNormal * RAY_OFFSET, lightPosition))
+		return 0.0f;
+	// Same falloff as lighting.glsl, so baked and shaded lights fade out alike.
+	float attenuation = quadratic * distance * distance + linear * distance + constant;
+	float window = glm::clamp(1.0f - powf(distance / range, 4.0f), 0.0f, 1.0f);
+	return lambert / attenuation * window * window;
+}
+
+glm::vec3 LightmapBaker::shade(const Sample& sample, const AmbientLight& ambient, const std::vector<PointLight>& points, const std::vector<SpotLight>& spots) const
+{
+	glm::vec3 color = ambient.diffuseColor * ambient.diffuseStrength;
+	for (const PointLight& light : points)
+	{
+		if (light.diffuseStrength > 0.0f)
+			color += light.diffuseColor * light.diffuseStrength * reach(sample, light.position, light.range, light.constant, light.linear, light.quadratic);
+	}
+	for (const SpotLight& light : spots)
+	{
+		if (light.diffuseStrength <= 0.0f)
+			continue;
+		glm::vec3 fromLight = glm::normalize(sample.position - light.position);
+		float spotFactor = glm::dot(fromLight, light.direction);
+		if (spotFactor <= light.edgeRad)
+			continue;
+		float cone = (spotFactor - light.edgeRad) / (1.0f - light.edgeRad);
+		color += light.diffuseColor * light.diffuseStrength * cone * reach(sample, light.position, light.range, light.constant, light.linear, light.quadratic);
+	}
+	return color;
+}
+
+void LightmapBaker::bake(const AmbientLight& ambient, const std::vector<PointLight>& points, const std::vector<SpotLight>& spots, unsigned threads)
+{
+	size_t texelCount = (size_t)m_size * m_size;
+	m_samples.assign(texelCount, Sample());
+	m_covered.assign(texelCount, 0);
+	m_texels.assign(texelCount, glm::vec3(0.0f));
+	for (const Triangle& triangle : m_triangles)
+		rasterize(triangle);
+	buildBvh();
+
+	if (threads == 0)
+		threads = std::max(std::thread::hardware_concurrency(), 1u);
+	std::atomic<int> nextRow(0);
+	auto work = [&]() {
+		for (int y = nextRow++; y < m_size; y = nextRow++)
+		{
+			for (int x = 0; x < m_size; x++)
+			{
+				size_t i = (size_t)y * m_size + x;
+				if (m_covered[i])
+					m_texels[i] = shade(m_samples[i], ambient, points, spots);
+			}
+		}
+	};
+	std::vector<std::thread> workers;
+	for (unsigned i = 1; i < threads; i++)
+		workers.emplace_back(work);
+	work();
+	for (std::thread& worker : workers)
+		worker.join();
+
+	dilate();
+	// Only needed while baking.
+	m_samples.clear();
+	m_samples.shrink_to_fit();
+}
+
+// Grows every chart into its padding, so bilinear filtering at a chart's edge never reads unbaked black.
+void LightmapBaker::dilate()
+{
+	for (int pass = 0; pass < DILATE_PASSES; pass++)
+	{
+		std::vector<char> covered = m_covered;
+		for (int y = 0; y < m_size; y++)
+		{
+			for (int x = 0; x < m_size; x++)
+			{
+				size_t i = (size_t)y * m_size + x;
+				if (covered[i])
+					continue;
+				glm::vec3 sum(0.0f);
+				int count = 0;
+				for (int dy = -1; dy <= 1; dy++)
+				{
+					for (int dx = -1; dx <= 1; dx++)
+					{
+						int nx = x + dx, ny = y + dy;
+						if (nx < 0 || ny < 0 || nx >= m_size || ny >= m_size || !covered[(size_t)ny * m_size + nx])
+							continue;
+						sum += m_texels[(size_t)ny * m_size + nx];
+						count++;
+					}
+				}
+				if (count == 0)
+					continue;
+				m_texels[i] = sum / (float)count;
+				m_covered[i] = 1;
+			}
+		}
+	}
+}
+
+bool LightmapBaker::write(const std::string& fileName) const
+{
+	std::ofstream file(fileName, std::ios::binary);
+	if (!file)
+		return false;
+	file << "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y " << m_size << " +X " << m_size << "\n";
+	// Flat RGBE scanlines, top row first.
+	std::vector<unsigned char> row((size_t)m_size * 4);
+	for (int y = m_size - 1; y >= 0; y--)
+	{
+		for (int x = 0; x < m_size; x++)
+		{
+			const glm::vec3& color = m_texels[(size_t)y * m_size + x];
+			float brightest = std::max(color.x, std::max(color.y, color.z));
+			unsigned char* rgbe = &row[(size_t)x * 4];
+			if (brightest < 1e-32f)
+			{
+				rgbe[0] = rgbe[1] = rgbe[2] = rgbe[3] = 0;
+				continue;
+			}
+			int exponent;
+			float scale = frexpf(brightest, &exponent) * 256.0f / brightest;
+			rgbe[0] = (unsigned char)(color.x * scale);
+			rgbe[1] = (unsigned char)(color.y * scale);
+			rgbe[2] = (unsigned char)(color.z * scale);
+			rgbe[3] = (unsigned char)(exponent + 128);
+		}
+		file.write((const char*)row.data(), row.size());
+	}
+	return (bool)file;
+}
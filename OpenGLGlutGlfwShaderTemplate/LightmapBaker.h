@@ -0,0 +1,91 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <string>
+#include <vector>
+
+#include "Light.h"
+
+// A world-space triangle mesh the lightmap covers. Plain CPU data, so baking never needs a GL context.
+struct LightmapMesh
+{
+	std::vector<glm::vec3> positions;
+	std::vector<glm::vec3> normals;
+	std::vector<unsigned> indices;
+	// Filled in by LightmapBaker::unwrap. A vertex shared by two charts needs a copy per chart, so unwrap
+	// rewrites indices to a new vertex list: new vertex i copies original vertex remap[i] and sits at
+	// lightmapUvs[i]. remap is sorted, so the copies of a contiguous vertex range stay contiguous.
+	std::vector<unsigned> remap;
+	std::vector<glm::vec2> lightmapUvs;
+};
+
+// Bakes the static lights into one lightmap atlas for the whole static scene, on the CPU.
+// Every mesh is split into planar charts that are packed into the atlas at one texel density. Each texel
+// then gets the ambient light plus the diffuse light of every point and spot light that reaches it, with a
+// ray cast against the scene for visibility. Rows of texels are shared out between threads.
+class LightmapBaker
+{
+public:
+	explicit LightmapBaker(int size = 1024);
+
+	// The mesh must stay alive until bake. Every mesh both receives light and blocks it.
+	void add(LightmapMesh* mesh);
+	// Fills in remap, indices and lightmapUvs of every mesh. False if the charts don't fit the atlas.
+	bool unwrap();
+	// Only diffuse light is baked, specular depends on the view. threads = 0 uses every hardware thread.
+	void bake(const AmbientLight& ambient, const std::vector<PointLight>& points, const std::vector<SpotLight>& spots, unsigned threads = 0);
+	// Radiance .hdr, which stb_image reads back with stbi_loadf. Row 0 of texels() ends up at v = 0.
+	bool write(const std::string& fileName) const;
+
+	int size() const { return m_size; }
+	size_t chartCount() const { return m_chartCount; }
+	float texelsPerUnit() const { return m_texelsPerUnit; }
+	// size x size linear colors, row by row from v = 0.
+	const std::vector<glm::vec3>& texels() const { return m_texels; }
+
+private:
+	struct Triangle
+	{
+		glm::vec3 position[3];
+		glm::vec3 normal[3];
+		glm::vec2 uv[3];
+	};
+
+	// Surface point a texel stands for.
+	struct Sample
+	{
+		glm::vec3 position;
+		glm::vec3 normal; // Interpolated, for the Lambert term.
+		glm::vec3 faceNormal; // Geometric, to move shadow rays off the surface.
+	};
+
+	// Leaves hold count triangles from m_order starting at first. Inner nodes have count 0 and
+	// their two children at first and first + 1.
+	struct BvhNode
+	{
+		glm::vec3 min, max;
+		unsigned first, count;
+	};
+
+	void rasterize(const Triangle& triangle);
+	void buildBvh();
+	void split(unsigned node, unsigned first, unsigned count);
+	bool occluded(glm::vec3 origin, glm::vec3 target) const;
+	// Lambert term times distance falloff of a light at lightPosition, 0 if it is out of range, behind the surface or blocked.
+	float reach(const Sample& sample, glm::vec3 lightPosition, float range, float constant, float linear, float quadratic) const;
+	glm::vec3 shade(const Sample& sample, const AmbientLight& ambient, const std::vector<PointLight>& points, const std::vector<SpotLight>& spots) const;
+	void dilate();
+
+	int m_size;
+	std::vector<LightmapMesh*> m_meshes;
+	size_t m_chartCount = 0;
+	float m_texelsPerUnit = 0.0f;
+
+	std::vector<Triangle> m_triangles;
+	std::vector<unsigned> m_order; // Triangle indices, grouped by BVH leaf.
+	std::vector<BvhNode> m_nodes;
+	std::vector<Sample> m_samples;
+	std::vector<char> m_covered; // Whether a triangle covers the texel's center.
+	std::vector<glm::vec3> m_texels;
+
+};
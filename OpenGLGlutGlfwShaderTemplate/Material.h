@@ -0,0 +1,16 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "ShaderProgram.h"
+#include "Texture.h"
+
+// How a surface is shaded. Every draw carries one, and DrawQueue only changes the program, the texture
+// or the mat uniforms when a draw's material differs from the one before it.
+struct Material
+{
+	const ShaderProgram* program; // Forward shader variant. Passes like the G-buffer or the shadows use their own program instead.
+	Texture* texture; // Bound to unit 0 as texture0.
+	GLfloat specularStrength;
+	GLfloat shininess;
+};
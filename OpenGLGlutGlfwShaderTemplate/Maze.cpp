@@ -0,0 +1,514 @@
+#include "Maze.h"
+#include "MeshRegistry.h"
+
+glm::mat4 mazeGridModel()
+{
+	return MazeShape::modelMatrix(glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(1, 0, 0), -90.0f, glm::vec3(-5.0f, 0.0f, 6.0f));
+}
+
+void addMazeShapes(const MazeGroups& groups)
+{
+	MazeShape& hedges = groups.hedges;
+	MazeShape& wall = groups.wall;
+	MazeShape& roof = groups.roof;
+	MazeShape& door = groups.door;
+	MazeShape& stair = groups.stair;
+	MazeShape& middleRoom = groups.middleRoom;
+	float scaleX = 1;
+	float scaleZ = 1;
+	// row 0
+	hedges.addShape(MeshRegistry::GetCube(31, 2, 1), { glm::vec3(0,0,0) ,glm::vec3(31,2,1),glm::vec3(1,0,0),0 });
+	// row 1
+	hedges.addShape(MeshRegistry::GetCube(1, 2, 1), { glm::vec3(0,0,-1) ,glm::vec3(1,2,1),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(1, 2, 1), { glm::vec3(2,0,-1) ,glm::vec3(1,2,1),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(1, 2, 1), { glm::vec3(12,0,-1) ,glm::vec3(1,2,1),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(1, 2, 1), { glm::vec3(24,0,-1) ,glm::vec3(1,2,1),glm::vec3(1,0,0),0 });
+	// row 2
+	hedges.addShape(MeshRegistry::GetCube(1, 2, 1), { glm::vec3(0,0,-2) ,glm::vec3(1,2,1),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(3, 2, 1), { glm::vec3(2,0,-2) ,glm::vec3(3,2,1),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(13, 2, 1), { glm::vec3(6,0,-2) ,glm::vec3(13,2,1),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(3, 2, 1), { glm::vec3(20,0,-2) ,glm::vec3(3,2,1),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(1, 2, 1), { glm::vec3(24,0,-2) ,glm::vec3(1,2,1),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(5, 2, 1), { glm::vec3(26,0,-2) ,glm::vec3(5,2,1),glm::vec3(1,0,0),0 });
+	// row 3
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-3) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(2,0,-3) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(10,0,-3) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(14,0,-3) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(18,0,-3) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(20,0,-3) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(26,0,-3) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-3) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	// row 4
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 3;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(2,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(6,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 3;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(8,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(12,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 3;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(14,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(18,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(20,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 5;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(22,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(28,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-4) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 5
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(2,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(6,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(12,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(16,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(18,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(20,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(22,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(24,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(26,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(28,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-5) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 6
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-6) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 5;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(2,0,-6) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 7;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(8,0,-6) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(16,0,-6) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 3;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(18,0,-6) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(22,0,-6) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(24,0,-6) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(26,0,-6) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(28,0,-6) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-6) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 7
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-7) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(2,0,-7) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(4,0,-7) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(10,0,-7) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(16,0,-7) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(24,0,-7) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(28,0,-7) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-7) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 8
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-8) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(2,0,-8) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(4,0,-8) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 13;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(6,0,-8) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(20,0,-8) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 5;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(22,0,-8) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(28,0,-8) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-8) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 9
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-9) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(2,0,-9) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(4,0,-9) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(18,0,-9) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(20,0,-9) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(28,0,-9) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-9) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 10
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-10) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(2,0,-10) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 3;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(4,0,-10) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 13;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(8,0,-10) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(22,0,-10) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 5;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(24,0,-10) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-10) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 11
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-11) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(4,0,-11) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(6,0,-11) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(8,0,-11) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(10,0,-11) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(20,0,-11) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(24,0,-11) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(28,0,-11) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-11) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 12
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-12) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 3;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(2,0,-12) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(6,0,-12) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(8,0,-12) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(10,0,-12) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 3;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(20,0,-12) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(24,0,-12) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(26,0,-12) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 3;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(28,0,-12) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 13
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-13) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(4,0,-13) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(6,0,-13) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(8,0,-13) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(10,0,-13) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(20,0,-13) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(26,0,-13) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(28,0,-13) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-13) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 14
+	scaleX = 3;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-14) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(4,0,-14) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(6,0,-14) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(8,0,-14) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(10,0,-14) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 3;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(20,0,-14) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(24,0,-14) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(28,0,-14) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-14) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 15
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-15) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(10,0,-15) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(20,0,-15) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(24,0,-15) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(26,0,-15) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-15) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 16
+	scaleX = 5;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-16) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(6,0,-16) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(20,0,-16) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 3;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(26,0,-16) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-16) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 17
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-17) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(10,0,-17) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(20,0,-17) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(24,0,-17) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(28,0,-17) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-17) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 18
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-18) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(2,0,-18) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 7;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(4,0,-18) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 3;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(20,0,-18) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(24,0,-18) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(28,0,-18) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-18) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 19
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-19) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(2,0,-19) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(4,0,-19) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(10,0,-19) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(20,0,-19) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(26,0,-19) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-19) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 20
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-20) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 3;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(2,0,-20) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(6,0,-20) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 3;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(12,0,-20) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 7;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(16,0,-20) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 3;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(24,0,-20) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(28,0,-20) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-20) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 21
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-21) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(6,0,-21) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(14,0,-21) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(20,0,-21) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(26,0,-21) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(28,0,-21) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-21) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 22
+	scaleX = 3;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-22) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 7;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(4,0,-22) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(12,0,-22) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 3;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(14,0,-22) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(18,0,-22) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(22,0,-22) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(24,0,-22) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-22) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 3;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(26,0,-22) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 23
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-23) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(2,0,-23) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(12,0,-23) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(14,0,-23) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(18,0,-23) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(22,0,-23) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(24,0,-23) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-23) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 24
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-24) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(6,0,-24) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(8,0,-24) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(10,0,-24) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(12,0,-24) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(14,0,-24) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-24) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 3;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(2,0,-24) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 7;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(16,0,-24) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 5;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(24,0,-24) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 25
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(4,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(6,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(8,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(10,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(12,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(14,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(18,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(22,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(26,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(28,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-25) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 26
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(4,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(6,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(16,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(18,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(26,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(28,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 3;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(4,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(8,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(12,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 5;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(20,0,-26) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 27
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-27) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(6,0,-27) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(10,0,-27) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(12,0,-27) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(16,0,-27) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(18,0,-27) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(20,0,-27) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(26,0,-27) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(28,0,-27) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-27) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 28
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-28) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(20,0,-28) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(28,0,-28) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-28) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 11;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(2,0,-28) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 5;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(14,0,-28) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(22,0,-28) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 29
+	scaleX = 1;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(2,0,-29) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(22,0,-29) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(30,0,-29) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// row 30
+	scaleX = 31;
+	hedges.addShape(MeshRegistry::GetCube(scaleX, 2, scaleZ), { glm::vec3(0,0,-30) ,glm::vec3(scaleX,2,scaleZ),glm::vec3(1,0,0),0 });
+
+	// wall
+	scaleX = 3;
+	scaleZ = 38;
+	wall.addShape(MeshRegistry::GetCube(scaleX, 6, scaleZ), { glm::vec3(0,0,-41) ,glm::vec3(scaleX,6,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 3;
+	scaleZ = 38;
+	wall.addShape(MeshRegistry::GetCube(scaleX, 6, scaleZ), { glm::vec3(38,0,-41) ,glm::vec3(scaleX,6,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 35;
+	scaleZ = 3;
+	wall.addShape(MeshRegistry::GetCube(scaleX, 6, scaleZ), { glm::vec3(3,0,-41) ,glm::vec3(scaleX,6,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 17;
+	scaleZ = 3;
+	wall.addShape(MeshRegistry::GetCube(scaleX, 6, scaleZ), { glm::vec3(0,0,-3) ,glm::vec3(scaleX,6,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 17;
+	scaleZ = 3;
+	wall.addShape(MeshRegistry::GetCube(scaleX, 6, scaleZ), { glm::vec3(24,0,-3) ,glm::vec3(scaleX,6,scaleZ),glm::vec3(1,0,0),0 });
+	scaleX = 7;
+	scaleZ = 3;
+	wall.addShape(MeshRegistry::GetCube(scaleX, 1, scaleZ), { glm::vec3(17,5,-3) ,glm::vec3(scaleX,1,scaleZ),glm::vec3(1,0,0),0 });
+
+	scaleX = 0.5f;
+	scaleZ = 0.5f;
+	//south crenel
+	for(int i = 1; i < 40; i++)
+	{
+		wall.addShape(MeshRegistry::GetCube(0.5f, 0.5f, 0.5f), { glm::vec3(i,6,-0.5) ,glm::vec3(scaleX,0.5f,scaleZ),glm::vec3(1,0,0),0 });
+		wall.addShape(MeshRegistry::GetCube(0.5f, 0.5f, 0.5f), { glm::vec3(i,6,-41) ,glm::vec3(scaleX,0.5f,scaleZ),glm::vec3(1,0,0),0 });
+		wall.addShape(MeshRegistry::GetCube(0.5f, 0.5f, 0.5f), { glm::vec3(0,6,-i-1) ,glm::vec3(scaleX,0.5f,scaleZ),glm::vec3(1,0,0),0 });
+		wall.addShape(MeshRegistry::GetCube(0.5f, 0.5f, 0.5f), { glm::vec3(40.5f,6,-i - 1) ,glm::vec3(scaleX,0.5f,scaleZ),glm::vec3(1,0,0),0 });
+	}
+
+	for (int i = 3; i < 38; i++)
+	{
+		wall.addShape(MeshRegistry::GetCube(0.5f, 0.5f, 0.5f), { glm::vec3(i,6,-3) ,glm::vec3(scaleX,0.5f,scaleZ),glm::vec3(1,0,0),0 });
+		wall.addShape(MeshRegistry::GetCube(0.5f, 0.5f, 0.5f), { glm::vec3(i,6,-38.5f) ,glm::vec3(scaleX,0.5f,scaleZ),glm::vec3(1,0,0),0 });
+		wall.addShape(MeshRegistry::GetCube(0.5f, 0.5f, 0.5f), { glm::vec3(2.5,6,-i - 1) ,glm::vec3(scaleX,0.5f,scaleZ),glm::vec3(1,0,0),0 });
+		wall.addShape(MeshRegistry::GetCube(0.5f, 0.5f, 0.5f), { glm::vec3(38,6,-i - 1) ,glm::vec3(scaleX,0.5f,scaleZ),glm::vec3(1,0,0),0 });
+	}
+	scaleX = 5;
+	scaleZ = 5;
+	wall.addShape(MeshRegistry::GetPrism(18), { glm::vec3(-1,0,-4) ,glm::vec3(scaleX,10,scaleZ),glm::vec3(1,0,0),0 });
+	wall.addShape(MeshRegistry::GetPrism(18), { glm::vec3(37,0,-4) ,glm::vec3(scaleX,10,scaleZ),glm::vec3(1,0,0),0 });
+	wall.addShape(MeshRegistry::GetPrism(18), { glm::vec3(-1,0,-42) ,glm::vec3(scaleX,10,scaleZ),glm::vec3(1,0,0),0 });
+	wall.addShape(MeshRegistry::GetPrism(18), { glm::vec3(37,0,-42) ,glm::vec3(scaleX,10,scaleZ),glm::vec3(1,0,0),0 });
+
+	wall.addShape(MeshRegistry::GetPrism(8), { glm::vec3(13,0,-4) ,glm::vec3(scaleX,8,scaleZ),glm::vec3(1,0,0),0 });
+	wall.addShape(MeshRegistry::GetPrism(8), { glm::vec3(23,0,-4) ,glm::vec3(scaleX,8,scaleZ),glm::vec3(1,0,0),0 });
+
+	scaleX = 7;
+	scaleZ = 7;
+	roof.addShape(MeshRegistry::GetCone(18), { glm::vec3(-2,10,-5) ,glm::vec3(scaleX,3,scaleZ),glm::vec3(1,0,0),0 });
+	roof.addShape(MeshRegistry::GetCone(18), { glm::vec3(36,10,-5) ,glm::vec3(scaleX,3,scaleZ),glm::vec3(1,0,0),0 });
+	roof.addShape(MeshRegistry::GetCone(18), { glm::vec3(-2,10,-43) ,glm::vec3(scaleX,3,scaleZ),glm::vec3(1,0,0),0 });
+	roof.addShape(MeshRegistry::GetCone(18), { glm::vec3(36,10,-43) ,glm::vec3(scaleX,3,scaleZ),glm::vec3(1,0,0),0 });
+
+	roof.addShape(MeshRegistry::GetCone(8), { glm::vec3(12,8,-5) ,glm::vec3(scaleX,3,scaleZ),glm::vec3(1,0,0),0 });
+	roof.addShape(MeshRegistry::GetCone(8), { glm::vec3(22,8,-5) ,glm::vec3(scaleX,3,scaleZ),glm::vec3(1,0,0),0 });
+
+	scaleX = 10;
+	scaleZ = 3;
+	stair.addShape(MeshRegistry::GetCube(scaleX,0.5f, scaleZ), { glm::vec3(15,0,-3) ,glm::vec3(scaleX,0.5f,scaleZ),glm::vec3(1,0,0),0 });
+	scaleZ = 2;
+	stair.addShape(MeshRegistry::GetCube(scaleX, 0.5f, scaleZ), { glm::vec3(15,0.5,-2.5) ,glm::vec3(scaleX,0.5f,scaleZ),glm::vec3(1,0,0),0 });
+
+	scaleX = 2.5;
+	scaleZ = 0.1;
+	door.addShape(MeshRegistry::GetCube(scaleX, 4, scaleZ), { glm::vec3(18,1,-1.5) ,glm::vec3(scaleX,4,scaleZ),glm::vec3(1,0,0),0 });
+	door.addShape(MeshRegistry::GetCube(scaleX, 4, scaleZ), { glm::vec3(21,1,-1.5) ,glm::vec3(scaleX,4,scaleZ),glm::vec3(1,0,0),0 });
+
+
+	scaleX = 9;
+	scaleZ = 9;
+	middleRoom.addShape(MeshRegistry::GetCube(scaleX, 0.5, scaleZ), { glm::vec3(11,0,-19) ,glm::vec3(scaleX,0.5,scaleZ),glm::vec3(1,0,0),0 });
+
+	scaleX = 1;
+	scaleZ = 1;
+	middleRoom.addShape(MeshRegistry::GetCube(scaleX, 3, scaleZ), { glm::vec3(13,0.5,-17) ,glm::vec3(scaleX,3,scaleZ),glm::vec3(1,0,0),0 });
+	middleRoom.addShape(MeshRegistry::GetCube(scaleX, 3, scaleZ), { glm::vec3(17,0.5,-17) ,glm::vec3(scaleX,3,scaleZ),glm::vec3(1,0,0),0 });
+	middleRoom.addShape(MeshRegistry::GetCube(scaleX, 3, scaleZ), { glm::vec3(13,0.5,-13) ,glm::vec3(scaleX,3,scaleZ),glm::vec3(1,0,0),0 });
+	middleRoom.addShape(MeshRegistry::GetCube(scaleX, 3, scaleZ), { glm::vec3(17,0.5,-13) ,glm::vec3(scaleX,3,scaleZ),glm::vec3(1,0,0),0 });
+
+	scaleX = 9;
+	scaleZ = 9;
+	middleRoom.addShape(MeshRegistry::GetCube(scaleX, 0.5, scaleZ), { glm::vec3(11,3.5,-19) ,glm::vec3(scaleX,0.5,scaleZ),glm::vec3(1,0,0),0 });
+}
+
+// Same groups and positions the game draws.
+void addMazeToBatch(StaticBatch& batch, const MazeGroups& groups, const MazeMaterials& materials)
+{
+	batch.add(groups.grid, mazeGridModel(), materials.dirt);
+	batch.add(groups.hedges, { 0, 0, 0 }, materials.hedge);
+	batch.add(groups.wall, CASTLE_POSITION, materials.stone);
+	batch.add(groups.roof, CASTLE_POSITION, materials.roof);
+	batch.add(groups.stair, CASTLE_POSITION, materials.stoneFloor);
+	batch.add(groups.door, CASTLE_POSITION, materials.wood);
+	batch.add(groups.middleRoom, { 0, 0, 0 }, materials.stoneFloor);
+}
+
+AmbientLight mazeAmbientLight()
+{
+	return AmbientLight(
+		glm::vec3(1.0f, 1.0f, 1.0f),	// Diffuse color.
+		0.5f);							// Diffuse strength.
+}
+
+std::vector<PointLight> mazePointLights()
+{
+	return { { glm::vec3(5.0f, 2, -5.0f), 50.0f, 1.0, 4.5f, 75.0f, glm::vec3(1.0f, 1.0f, 1.0f), 5 },
+		{ glm::vec3(25.0f, 2, -5.0f), 50.0f, 1.0, 4.5f, 75.0f, glm::vec3(1.0f, 1.0f, 1.0f), 5 },
+		{ glm::vec3(5.0f, 2, -25.0f), 50.0f, 1.0, 4.5f, 75.0f, glm::vec3(1.0f, 1.0f, 1.0f), 5 },
+		{ glm::vec3(25.0f, 2, -25.0f), 50.0f, 1.0, 4.5f, 75.0f, glm::vec3(1.0f, 1.0f, 1.0f), 5 },
+		{ glm::vec3(15.0f, 2, -15.0f), 50.0f, 1.0, 4.5f, 75.0f, glm::vec3(1.0f, 1.0f, 1.0f), 0 } };
+}
+
+// Spot lights only reach their cone, so they cost far less than point lights of the same range.
+std::vector<SpotLight> mazeSpotLights()
+{
+	return { { glm::vec3(1.0f, 6.0f, -1.0f), 10.0f, 1.0f, 4.5f, 75.0f, glm::vec3(0.6f, 0.8f, 1.0f), 6.0f, glm::vec3(0.0f, -1.0f, 0.0f), 25.0f },
+		{ glm::vec3(29.0f, 6.0f, -1.0f), 10.0f, 1.0f, 4.5f, 75.0f, glm::vec3(0.6f, 0.8f, 1.0f), 6.0f, glm::vec3(0.0f, -1.0f, 0.0f), 25.0f },
+		{ glm::vec3(1.0f, 6.0f, -29.0f), 10.0f, 1.0f, 4.5f, 75.0f, glm::vec3(0.6f, 0.8f, 1.0f), 6.0f, glm::vec3(0.0f, -1.0f, 0.0f), 25.0f },
+		{ glm::vec3(29.0f, 6.0f, -29.0f), 10.0f, 1.0f, 4.5f, 75.0f, glm::vec3(0.6f, 0.8f, 1.0f), 6.0f, glm::vec3(0.0f, -1.0f, 0.0f), 25.0f } };
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Light.h"
+#include "Material.h"
+#include "MazeShape.h"
+#include "Shape.h"
+#include "StaticBatch.h"
+
+// The maze's static geometry and the lights that are always there. Shared by the game and LightmapBake, so both
+// build the same scene and bake the same lightmap. Nothing here touches GL; meshes are only buffered if
+// MeshRegistry does so.
+
+#define MAZE_GRID_SIZE 41 // Quads along each side of the ground grid.
+#define CASTLE_POSITION glm::vec3(-5, 0, 6) // Offset of the wall, roof, stair and door groups.
+#define BASE_POINT_LIGHTS 5 // Point lights that are always there. 'l' adds torches after them.
+#define BASE_SPOT_LIGHTS 4 // Spot lights that are always there. 'k' adds lamps after them.
+// Ambient, base point and base spot lights of the static scene, baked on the CPU at startup when the file is missing.
+#define LIGHTMAP_FILE "Media/lightmap.hdr"
+#define LIGHTMAP_SIZE 1024
+
+// The groups the maze is drawn in, one per material.
+struct MazeGroups
+{
+	Grid& grid; // Placed by mazeGridModel().
+	MazeShape& hedges;
+	MazeShape& wall;
+	MazeShape& roof;
+	MazeShape& door;
+	MazeShape& stair;
+	MazeShape& middleRoom;
+};
+
+struct MazeMaterials
+{
+	const Material* dirt;
+	const Material* hedge;
+	const Material* stone;
+	const Material* roof;
+	const Material* wood;
+	const Material* stoneFloor;
+};
+
+// The grid never moves.
+glm::mat4 mazeGridModel();
+// Adds every piece of the maze to its group, with meshes from MeshRegistry.
+void addMazeShapes(const MazeGroups& groups);
+// Adds the grid and every group to batch, grouped by material. The lightmap atlas depends on which groups share a
+// batch and on the order they were added in, so a lightmap only fits the batch it was baked from this way.
+void addMazeToBatch(StaticBatch& batch, const MazeGroups& groups, const MazeMaterials& materials);
+
+AmbientLight mazeAmbientLight();
+// The first BASE_POINT_LIGHTS point lights and BASE_SPOT_LIGHTS spot lights.
+std::vector<PointLight> mazePointLights();
+std::vector<SpotLight> mazeSpotLights();
@@ -1,46 +1,220 @@
 #include "MazeShape.h"
+#include "LightAssignment.h"
 
-#include <GL/glew.h>
+#include <algorithm>
 #include <glm/gtc/matrix_transform.hpp>
 
-void MazeShape::transformObject(glm::vec3 scale, glm::vec3 rotationAxis, float rotationAngle, glm::vec3 translation)
+glm::mat4 MazeShape::modelMatrix(glm::vec3 scale, glm::vec3 rotationAxis, float rotationAngle, glm::vec3 translation)
 {
 	glm::mat4 Model;
 	Model = glm::mat4(1.0f);
 	Model = glm::translate(Model, translation);
 	Model = glm::rotate(Model, glm::radians(rotationAngle), rotationAxis);
 	Model = glm::scale(Model, scale);
+	return Model;
+}
 
-	// We must now update the View.
-	//calculateView();
+int MazeShape::addShape(std::shared_ptr<Shape> shape, Transform transform, glm::vec3 tint)
+{
+	// Shapes come from MeshRegistry already buffered and may be shared with other entries.
+	m_shape.push_back({ shape, transform, tint, NO_OBJECT_LIGHTS });
+	m_worldMatrices.push_back(glm::mat4(1.0f));
+	m_normalMatrices.push_back(glm::mat3(1.0f));
+	m_worldBounds.push_back(shape->Bounds());
+	m_matrixDirty.push_back(false);
+	markDirty(m_shape.size() - 1);
+	m_groupsDirty = true;
+	return m_shape.size() - 1;
+}
 
-	glUniformMatrix4fv(*m_modelID, 1, GL_FALSE, &Model[0][0]);
+void MazeShape::setTransform(int index, Transform transform)
+{
+	m_shape[index].transform = transform;
+	markDirty(index);
 }
 
-void MazeShape::addShape(Shape shape, Transform transform)
+void MazeShape::setTint(int index, glm::vec3 tint)
 {
-	shape.BufferShape();
-	m_shape.push_back(pair<Shape, Transform>(shape, transform));
+	m_shape[index].tint = tint;
+	// Tint lives next to the matrix in the instance buffer, so it follows the same path.
+	markDirty(index);
+}
 
+void MazeShape::clear()
+{
+	m_shape.clear();
+	m_worldMatrices.clear();
+	m_normalMatrices.clear();
+	m_worldBounds.clear();
+	m_matrixDirty.clear();
+	m_dirtyEntries.clear();
+	m_changedEntries.clear();
+	m_groups.clear();
+	m_instanceSlot.clear();
+	m_instanceBuffer.reset();
+	m_groupsDirty = true;
+	m_lightsAssigned = false;
 }
 
-void MazeShape::draw(glm::vec3 position, Texture* texture)
+void MazeShape::markDirty(int index)
 {
-	if (m_modelID == nullptr)
+	if (m_matrixDirty[index])
+		return;
+	m_matrixDirty[index] = true;
+	m_dirtyEntries.push_back(index);
+}
+
+void MazeShape::updateMatrices(glm::vec3 position)
+{
+	// Moving the whole group invalidates every entry.
+	if (position != m_matrixPosition)
+	{
+		m_matrixPosition = position;
+		for (int i = 0; i < m_shape.size(); i++)
+			markDirty(i);
+	}
+
+	// Counted here rather than by whoever consumes m_changedEntries, so refresh() sees changes record() already queued uploads for.
+	if (!m_dirtyEntries.empty())
+		m_version++;
+	for (int i : m_dirtyEntries)
 	{
-		std::cout << "ModelID is empty!!! " << std::endl;
+		const Transform& t = m_shape[i].transform;
+		m_worldMatrices[i] = modelMatrix(t.scale, t.rotation, t.rotationAngle, t.position + position);
+		m_normalMatrices[i] = NormalMatrix(m_worldMatrices[i]);
+		m_worldBounds[i] = TransformBounds(m_shape[i].shape->Bounds(), m_worldMatrices[i]);
+		m_matrixDirty[i] = false;
+		m_changedEntries.push_back(i);
+	}
+	m_dirtyEntries.clear();
+}
+
+void MazeShape::updateLights()
+{
+	if (m_lights == nullptr || m_spots == nullptr || m_lightBuffer == nullptr)
 		return;
+	if (!m_lightsAssigned || m_lightBuffer->version() != m_lightVersion)
+	{
+		m_lightsAssigned = true;
+		m_lightVersion = m_lightBuffer->version();
+		m_version++;
+		m_changedEntries.clear();
+		for (int i = 0; i < m_shape.size(); i++)
+			m_changedEntries.push_back(i);
 	}
-	texture->Bind(GL_TEXTURE0);
+	// Entries that moved this frame, or every entry if the lights changed.
+	for (int i : m_changedEntries)
+		m_shape[i].lights = AssignLights(m_worldBounds[i], *m_lights, *m_spots);
+}
+
+void MazeShape::appendTo(BakedShape& batch, glm::vec3 position)
+{
+	updateMatrices(position);
 	for (int i = 0; i < m_shape.size(); i++)
+		batch.Append(*m_shape[i].shape, m_worldMatrices[i], m_shape[i].tint);
+}
+
+unsigned MazeShape::refresh(glm::vec3 position)
+{
+	updateMatrices(position);
+	updateLights();
+	// The instance buffer didn't see these changes; rewrite it if we switch back to instancing.
+	if (!m_changedEntries.empty())
 	{
+		m_changedEntries.clear();
+		m_groupsDirty = true;
+	}
+	return m_version;
+}
 
-		m_shape[i].first.RecolorShape(1.0f, 1.0f, 1.0f);
-		transformObject(m_shape[i].second.scale, m_shape[i].second.rotation, m_shape[i].second.rotationAngle
-			, { m_shape[i].second.position.x + position.x , m_shape[i].second.position.y + position.y, m_shape[i].second.position.z + position.z });
-		m_shape[i].first.DrawShape(GL_TRIANGLES);
+void MazeShape::buildInstances(CommandList& commands)
+{
+	// Visit entries grouped by mesh so each mesh's instances end up contiguous in the buffer.
+	std::vector<int> order(m_shape.size());
+	for (int i = 0; i < order.size(); i++)
+		order[i] = i;
+	std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+		return m_shape[a].shape.get() < m_shape[b].shape.get();
+	});
 
+	std::vector<InstanceData> instances;
+	instances.reserve(m_shape.size());
+	m_groups.clear();
+	m_instanceSlot.resize(m_shape.size());
+	for (int i : order)
+	{
+		const Entry& entry = m_shape[i];
+		if (m_groups.empty() || m_groups.back().mesh != entry.shape.get())
+			m_groups.push_back({ entry.shape.get(), (GLintptr)(instances.size() * sizeof(InstanceData)), 0, m_worldBounds[i] });
+		InstanceGroup& group = m_groups.back();
+		group.count++;
+		group.bounds.min = glm::min(group.bounds.min, m_worldBounds[i].min);
+		group.bounds.max = glm::max(group.bounds.max, m_worldBounds[i].max);
+		m_instanceSlot[i] = instances.size();
+		instances.push_back({ m_worldMatrices[i], entry.tint, entry.lights, m_normalMatrices[i] });
 	}
-	glBindTexture(GL_TEXTURE_2D, 0);
 
+	// Creates the buffer on replay if it doesn't exist yet.
+	commands.upload(&m_instanceBuffer, GL_ARRAY_BUFFER, 0, instances.data(), sizeof(InstanceData) * instances.size(), true);
+
+	m_changedEntries.clear();
+	m_groupsDirty = false;
+}
+
+void MazeShape::updateInstances(CommandList& commands)
+{
+	if (m_changedEntries.empty())
+		return;
+	// Past half the buffer one full upload beats many small ones.
+	if (m_changedEntries.size() * 2 > m_shape.size())
+	{
+		buildInstances(commands);
+		return;
+	}
+
+	for (int i : m_changedEntries)
+	{
+		InstanceData instance = { m_worldMatrices[i], m_shape[i].tint, m_shape[i].lights, m_normalMatrices[i] };
+		commands.upload(&m_instanceBuffer, GL_ARRAY_BUFFER, m_instanceSlot[i] * sizeof(InstanceData), &instance, sizeof(InstanceData), false);
+		for (InstanceGroup& group : m_groups)
+		{
+			if (group.mesh != m_shape[i].shape.get())
+				continue;
+			group.bounds.min = glm::min(group.bounds.min, m_worldBounds[i].min);
+			group.bounds.max = glm::max(group.bounds.max, m_worldBounds[i].max);
+		}
+	}
+	m_changedEntries.clear();
+}
+
+void MazeShape::record(CommandList& commands, glm::vec3 position, const Material* material)
+{
+	updateMatrices(position);
+	updateLights();
+	if (m_instanced)
+	{
+		if (m_groupsDirty)
+			buildInstances(commands);
+		else
+			updateInstances(commands);
+		for (const InstanceGroup& group : m_groups)
+		{
+			commands.draw({ material, group.mesh, nullptr, nullptr, glm::vec3(1.0f, 1.0f, 1.0f), NO_OBJECT_LIGHTS,
+				0, group.offset, group.count, (group.bounds.min + group.bounds.max) * 0.5f }, &m_instanceBuffer);
+		}
+		return;
+	}
+
+	// The instance buffer didn't see these changes; rewrite it if we switch back to instancing.
+	if (!m_changedEntries.empty())
+	{
+		m_changedEntries.clear();
+		m_groupsDirty = true;
+	}
+	for (int i = 0; i < m_shape.size(); i++)
+	{
+		const Entry& entry = m_shape[i];
+		commands.draw({ material, entry.shape.get(), &m_worldMatrices[i], &m_normalMatrices[i], entry.tint, entry.lights,
+			0, 0, 0, (m_worldBounds[i].min + m_worldBounds[i].max) * 0.5f });
+	}
 }
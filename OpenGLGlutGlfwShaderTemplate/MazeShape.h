@@ -2,10 +2,14 @@
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include <memory>
 #include <vector>
 
+#include "CommandList.h"
+#include "DrawQueue.h"
+#include "LightBuffer.h"
+#include "Material.h"
 #include "Shape.h"
-#include "Texture.h"
 
 
 struct Transform
@@ -23,15 +27,97 @@ public:
 	~MazeShape() = default;
 
 
-	void setModelID(GLuint* modelId) {
-		m_modelID = modelId;
+	// Gives every entry its own most relevant point and spot lights for the per-object light mode.
+	// They are reassigned when an entry moves or lightBuffer reports a change.
+	void setLights(const std::vector<PointLight>* lights, const std::vector<SpotLight>* spots, const LightBuffer* lightBuffer) {
+		m_lights = lights;
+		m_spots = spots;
+		m_lightBuffer = lightBuffer;
 	}
-	void transformObject(glm::vec3 scale, glm::vec3 rotationAxis, float rotationAngle, glm::vec3 translation);
-	void addShape(Shape shape, Transform transform);
-	void draw(glm::vec3 position, Texture* texture);
+	// Instanced mode draws every entry sharing a mesh with one call. On by default.
+	void setInstanced(bool instanced) {
+		m_instanced = instanced;
+	}
+	// Returns the index of the new entry, for use with setTransform/setTint.
+	int addShape(std::shared_ptr<Shape> shape, Transform transform, glm::vec3 tint = glm::vec3(1.0f, 1.0f, 1.0f));
+	// Records this group's draws, moved by position, along with the instance buffer writes they need: one draw
+	// per mesh when instanced, one per entry otherwise. Makes no GL calls, so a worker thread can record one
+	// group while others record theirs. The draws point into this group, so it must not change until the queue
+	// they are replayed into is flushed.
+	void record(CommandList& commands, glm::vec3 position, const Material* material);
+
+	int size() const { return m_shape.size(); }
+	const Transform& getTransform(int index) const { return m_shape[index].transform; }
+	// Mutating an entry only marks it dirty; its world matrix is recomputed on the next draw.
+	void setTransform(int index, Transform transform);
+	void setTint(int index, glm::vec3 tint);
+	// Drops every entry and deletes the instance buffer. Meshes go away once nothing else shares them.
+	void clear();
+
+	// Appends every entry, moved by position, to a baked world-space mesh.
+	void appendTo(BakedShape& batch, glm::vec3 position);
+	// Brings every entry's world matrix, bounds and lights up to date for position, for code that draws the
+	// entries through buffers of its own. The returned number changes whenever any of those did.
+	unsigned refresh(glm::vec3 position);
+	// Per-entry state as of the last refresh or record.
+	const Shape& getShape(int index) const { return *m_shape[index].shape; }
+	glm::vec3 getTint(int index) const { return m_shape[index].tint; }
+	const ObjectLights& getLights(int index) const { return m_shape[index].lights; }
+	const glm::mat4& worldMatrix(int index) const { return m_worldMatrices[index]; }
+	const glm::mat3& normalMatrix(int index) const { return m_normalMatrices[index]; }
+	const Aabb& worldBounds(int index) const { return m_worldBounds[index]; }
+
+	static glm::mat4 modelMatrix(glm::vec3 scale, glm::vec3 rotationAxis, float rotationAngle, glm::vec3 translation);
 
 private:
-	GLuint *m_modelID = nullptr;
-	std::vector<pair<Shape, Transform>> m_shape;
+	struct Entry
+	{
+		std::shared_ptr<Shape> shape;
+		Transform transform;
+		glm::vec3 tint;
+		ObjectLights lights;
+	};
+
+	// A run of consecutive instances in m_instanceBuffer that all use the same mesh.
+	struct InstanceGroup
+	{
+		Shape* mesh;
+		GLintptr offset;
+		GLsizei count;
+		Aabb bounds; // Around every instance, for the depth order. Only grows until the group is rebuilt.
+	};
+
+	void markDirty(int index);
+	void updateMatrices(glm::vec3 position);
+	void updateLights();
+	void buildInstances(CommandList& commands);
+	void updateInstances(CommandList& commands);
+
+	bool m_instanced = true;
+	std::vector<Entry> m_shape;
+
+	// World matrix of every entry, parallel to m_shape, including the position passed to record().
+	std::vector<glm::mat4> m_worldMatrices;
+	// NormalMatrix of each world matrix, recomputed only when the entry moves.
+	std::vector<glm::mat3> m_normalMatrices;
+	// World-space box of every entry, recomputed along with its matrix.
+	std::vector<Aabb> m_worldBounds;
+	std::vector<bool> m_matrixDirty;
+	std::vector<int> m_dirtyEntries;
+	// Entries whose matrix or tint changed since the instance buffer was last written.
+	std::vector<int> m_changedEntries;
+	glm::vec3 m_matrixPosition{0,0,0};
+
+	const std::vector<PointLight>* m_lights = nullptr;
+	const std::vector<SpotLight>* m_spots = nullptr;
+	const LightBuffer* m_lightBuffer = nullptr;
+	unsigned m_lightVersion = 0;
+	bool m_lightsAssigned = false;
+
+	std::vector<InstanceGroup> m_groups;
+	std::vector<int> m_instanceSlot;
+	GLBuffer m_instanceBuffer;
+	bool m_groupsDirty = true;
+	unsigned m_version = 0;
 
 };
@@ -0,0 +1,78 @@
+#include "MeshRegistry.h"
+
+bool MeshRegistry::MeshKey::operator<(const MeshKey& other) const
+{
+	if (type != other.type)
+		return type < other.type;
+	for (int i = 0; i < 3; i++)
+	{
+		if (params[i] != other.params[i])
+			return params[i] < other.params[i];
+	}
+	return false;
+}
+
+std::map<MeshRegistry::MeshKey, std::weak_ptr<Shape>>& MeshRegistry::meshes()
+{
+	static std::map<MeshKey, std::weak_ptr<Shape>> registry;
+	return registry;
+}
+
+bool& MeshRegistry::bufferMeshes()
+{
+	static bool buffer = true;
+	return buffer;
+}
+
+template <typename T, typename... Args>
+std::shared_ptr<Shape> MeshRegistry::get(const MeshKey& key, Args... args)
+{
+	std::weak_ptr<Shape>& slot = meshes()[key];
+	std::shared_ptr<Shape> mesh = slot.lock();
+	if (mesh == nullptr)
+	{
+		mesh = std::make_shared<T>(args...);
+		if (bufferMeshes())
+			mesh->BufferShape();
+		else
+			mesh->Prepare();
+		slot = mesh;
+	}
+	return mesh;
+}
+
+std::shared_ptr<Shape> MeshRegistry::GetCube(float x, float y, float z)
+{
+	return get<Cube>({ MESH_CUBE, { x, y, z } }, x, y, z);
+}
+
+std::shared_ptr<Shape> MeshRegistry::GetPrism(int sides)
+{
+	return get<Prism>({ MESH_PRISM, { (float)sides, 0, 0 } }, sides);
+}
+
+std::shared_ptr<Shape> MeshRegistry::GetCone(int sides)
+{
+	return get<Cone>({ MESH_CONE, { (float)sides, 0, 0 } }, sides);
+}
+
+std::shared_ptr<Shape> MeshRegistry::GetSphere(int subdivision)
+{
+	return get<Sphere>({ MESH_SPHERE, { (float)subdivision, 0, 0 } }, subdivision);
+}
+
+std::shared_ptr<Shape> MeshRegistry::GetGrid(int quads, int scale)
+{
+	return get<Grid>({ MESH_GRID, { (float)quads, (float)scale, 0 } }, quads, scale);
+}
+
+size_t MeshRegistry::Size()
+{
+	size_t count = 0;
+	for (auto& entry : meshes())
+	{
+		if (!entry.second.expired())
+			count++;
+	}
+	return count;
+}
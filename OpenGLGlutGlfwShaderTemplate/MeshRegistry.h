@@ -0,0 +1,39 @@
+#pragma once
+
+#include <map>
+#include <memory>
+
+#include "Shape.h"
+
+// Hands out one buffered Shape per unique primitive, so identical maze pieces share a VAO/VBO.
+// The registry only keeps weak references; a mesh is released once the last user lets go of it.
+class MeshRegistry
+{
+public:
+	static std::shared_ptr<Shape> GetCube(float x = 1, float y = 1, float z = 1);
+	static std::shared_ptr<Shape> GetPrism(int sides);
+	static std::shared_ptr<Shape> GetCone(int sides);
+	static std::shared_ptr<Shape> GetSphere(int subdivision);
+	static std::shared_ptr<Shape> GetGrid(int quads, int scale = 1);
+
+	// Number of distinct meshes currently alive.
+	static size_t Size();
+	// Off, meshes are only prepared, not buffered, for tools that build the maze without a GL context. On by default.
+	static void SetBuffering(bool buffering) { bufferMeshes() = buffering; }
+
+private:
+	enum MeshType { MESH_CUBE, MESH_PRISM, MESH_CONE, MESH_SPHERE, MESH_GRID };
+
+	struct MeshKey
+	{
+		MeshType type;
+		float params[3];
+		bool operator<(const MeshKey& other) const;
+	};
+
+	template <typename T, typename... Args>
+	static std::shared_ptr<Shape> get(const MeshKey& key, Args... args);
+
+	static std::map<MeshKey, std::weak_ptr<Shape>>& meshes();
+	static bool& bufferMeshes();
+};
@@ -0,0 +1,188 @@
+#include "Normals.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+#include <glm/glm.hpp>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define NORMALS_SSE
+#endif
+
+namespace
+{
+	// Below this many triangles spinning up threads costs more than it saves.
+	const size_t PARALLEL_THRESHOLD = 65536;
+
+	// Runs func(begin, end, worker) over [0, count) split into `workers` contiguous ranges, one thread each.
+	template <typename Func>
+	void parallelFor(size_t count, unsigned workers, Func func)
+	{
+		if (workers <= 1)
+		{
+			func(size_t(0), count, 0u);
+			return;
+		}
+		std::vector<std::thread> threads;
+		size_t chunk = (count + workers - 1) / workers;
+		for (unsigned w = 0; w < workers; w++)
+			threads.emplace_back(func, std::min(count, w * chunk), std::min(count, (w + 1) * chunk), w);
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+
+	// Adds the unit face normal of triangles [begin, end) to their corners. sums covers vertices from `first` on.
+	void accumulate(const GLuint* indices, const GLfloat* vertices, size_t begin, size_t end, GLuint first, float* sums)
+	{
+		for (size_t t = begin; t < end; t++)
+		{
+			const GLfloat* a = vertices + indices[t * 3] * 3;
+			const GLfloat* b = vertices + indices[t * 3 + 1] * 3;
+			const GLfloat* c = vertices + indices[t * 3 + 2] * 3;
+			float e1x = b[0] - a[0], e1y = b[1] - a[1], e1z = b[2] - a[2];
+			float e2x = c[0] - a[0], e2y = c[1] - a[1], e2z = c[2] - a[2];
+			float nx = e1y * e2z - e1z * e2y;
+			float ny = e1z * e2x - e1x * e2z;
+			float nz = e1x * e2y - e1y * e2x;
+			float len2 = nx * nx + ny * ny + nz * nz;
+			float inv = len2 > 0.0f ? 1.0f / sqrtf(len2) : 0.0f;
+			for (int k = 0; k < 3; k++)
+			{
+				float* sum = sums + (indices[t * 3 + k] - first) * 3;
+				sum[0] += nx * inv;
+				sum[1] += ny * inv;
+				sum[2] += nz * inv;
+			}
+		}
+	}
+
+	// Normalizes the xyz normals of vertices [begin, end) in place, four at a time.
+	void normalizeRange(GLfloat* normals, size_t begin, size_t end)
+	{
+		size_t v = begin;
+#ifdef NORMALS_SSE
+		for (; v + 4 <= end; v += 4)
+		{
+			float* n0 = normals + v * 3;
+			__m128 x = _mm_set_ps(n0[9], n0[6], n0[3], n0[0]);
+			__m128 y = _mm_set_ps(n0[10], n0[7], n0[4], n0[1]);
+			__m128 z = _mm_set_ps(n0[11], n0[8], n0[5], n0[2]);
+			__m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+			__m128 inv = _mm_and_ps(_mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(len2)), _mm_cmpgt_ps(len2, _mm_setzero_ps()));
+			alignas(16) float n[3][4];
+			_mm_store_ps(n[0], _mm_mul_ps(x, inv));
+			_mm_store_ps(n[1], _mm_mul_ps(y, inv));
+			_mm_store_ps(n[2], _mm_mul_ps(z, inv));
+			for (int k = 0; k < 4; k++)
+			{
+				n0[k * 3] = n[0][k];
+				n0[k * 3 + 1] = n[1][k];
+				n0[k * 3 + 2] = n[2][k];
+			}
+		}
+#endif
+		for (; v < end; v++)
+		{
+			float* n = normals + v * 3;
+			float len2 = n[0] * n[0] + n[1] * n[1] + n[2] * n[2];
+			float inv = len2 > 0.0f ? 1.0f / sqrtf(len2) : 0.0f;
+			n[0] *= inv; n[1] *= inv; n[2] *= inv;
+		}
+	}
+
+	// Sums from one thread's triangle range, covering vertices [first, last].
+	struct PartialSums
+	{
+		GLuint first = 0, last = 0;
+		std::vector<float> sums;
+	};
+}
+
+void ComputeVertexNormals(const GLuint* indices, size_t indexCount, const GLfloat* vertices, size_t vertexCount, GLfloat* normals)
+{
+	size_t triangleCount = indexCount / 3;
+	unsigned workers = triangleCount < PARALLEL_THRESHOLD ? 1 : std::max(1u, std::thread::hardware_concurrency());
+	if (workers == 1)
+	{
+		std::fill(normals, normals + vertexCount * 3, 0.0f);
+		accumulate(indices, vertices, 0, triangleCount, 0, normals);
+		normalizeRange(normals, 0, vertexCount);
+		return;
+	}
+
+	// Generated meshes are built row by row, so a contiguous run of triangles only touches a narrow
+	// band of vertices and each thread's private buffer stays small.
+	std::vector<PartialSums> partials(workers);
+	parallelFor(triangleCount, workers, [&](size_t begin, size_t end, unsigned worker) {
+		if (begin == end)
+			return;
+		PartialSums& partial = partials[worker];
+		auto range = std::minmax_element(indices + begin * 3, indices + end * 3);
+		partial.first = *range.first;
+		partial.last = *range.second;
+		partial.sums.assign((partial.last - partial.first + 1) * 3, 0.0f);
+		accumulate(indices, vertices, begin, end, partial.first, partial.sums.data());
+	});
+
+	// Each thread owns a vertex range, so nobody writes to the same normal.
+	parallelFor(vertexCount, workers, [&](size_t begin, size_t end, unsigned) {
+		std::fill(normals + begin * 3, normals + end * 3, 0.0f);
+		for (const PartialSums& partial : partials)
+		{
+			if (partial.sums.empty())
+				continue;
+			size_t from = std::max<size_t>(begin, partial.first);
+			size_t to = std::min<size_t>(end, partial.last + 1);
+			for (size_t i = from * 3; i < to * 3; i++)
+				normals[i] += partial.sums[i - partial.first * 3];
+		}
+		normalizeRange(normals, begin, end);
+	});
+}
+
+void ComputeVertexNormalsSerial(const GLuint* indices, size_t indexCount, const GLfloat* vertices, size_t vertexCount, GLfloat* normals)
+{
+	std::fill(normals, normals + vertexCount * 3, 0.0f);
+	// Calculate the normals of each triangle first.
+	for (size_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		unsigned in0 = indices[i] * 3;
+		unsigned in1 = indices[i + 1] * 3;
+		unsigned in2 = indices[i + 2] * 3;
+		glm::vec3 v1(vertices[in1] - vertices[in0], vertices[in1 + 1] - vertices[in0 + 1], vertices[in1 + 2] - vertices[in0 + 2]);
+		glm::vec3 v2(vertices[in2] - vertices[in0], vertices[in2 + 1] - vertices[in0 + 1], vertices[in2 + 2] - vertices[in0 + 2]);
+		glm::vec3 normal = glm::normalize(glm::cross(v1, v2));
+		normals[in0] += normal.x;	normals[in0 + 1] += normal.y;	normals[in0 + 2] += normal.z;
+		normals[in1] += normal.x;	normals[in1 + 1] += normal.y;	normals[in1 + 2] += normal.z;
+		normals[in2] += normal.x;	normals[in2 + 1] += normal.y;	normals[in2 + 2] += normal.z;
+	}
+	// Normalize each of the new normal vectors.
+	for (size_t i = 0; i < vertexCount * 3; i += 3)
+	{
+		glm::vec3 vec = glm::normalize(glm::vec3(normals[i], normals[i + 1], normals[i + 2]));
+		normals[i] = vec.x; normals[i + 1] = vec.y; normals[i + 2] = vec.z;
+	}
+}
+
+glm::mat3 NormalMatrix(const glm::mat4& model)
+{
+	glm::mat3 m(model);
+	float xx = glm::dot(m[0], m[0]), yy = glm::dot(m[1], m[1]), zz = glm::dot(m[2], m[2]);
+	float tolerance = 1e-6f * (xx + yy + zz);
+	if (std::fabs(glm::dot(m[0], m[1])) <= tolerance && std::fabs(glm::dot(m[1], m[2])) <= tolerance && std::fabs(glm::dot(m[2], m[0])) <= tolerance)
+	{
+		// Columns are perpendicular, so model is a rotation times a scale and each column only needs dividing by its squared length.
+		if (std::fabs(xx - yy) <= tolerance && std::fabs(yy - zz) <= tolerance)
+		{
+			float inverseScale = 1.0f / xx;
+			return glm::mat3(m[0] * inverseScale, m[1] * inverseScale, m[2] * inverseScale);
+		}
+		return glm::mat3(m[0] / xx, m[1] / yy, m[2] / zz);
+	}
+	// The inverse transpose is the cofactor matrix over the determinant.
+	glm::mat3 cofactor(glm::cross(m[1], m[2]), glm::cross(m[2], m[0]), glm::cross(m[0], m[1]));
+	float inverseDeterminant = 1.0f / glm::dot(m[0], cofactor[0]);
+	return glm::mat3(cofactor[0] * inverseDeterminant, cofactor[1] * inverseDeterminant, cofactor[2] * inverseDeterminant);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+
+// Averaged vertex normals for an indexed triangle list. Every triangle contributes its unit face
+// normal to its three corners, then each vertex sum is normalized.
+// vertices and normals hold xyz per vertex; normals must have room for vertexCount * 3 floats.
+// Large meshes are split into one triangle range per thread. Each thread sums face normals into its
+// own buffer covering just the vertex band its triangles touch; a second pass adds those buffers up
+// per vertex range, so no two threads write the same normal, and normalizes four vertices at a time
+// with SSE.
+void ComputeVertexNormals(const GLuint* indices, size_t indexCount, const GLfloat* vertices, size_t vertexCount, GLfloat* normals);
+
+// The original one-triangle-at-a-time version. Kept as the baseline for BENCHMARK_SHAPES.
+void ComputeVertexNormalsSerial(const GLuint* indices, size_t indexCount, const GLfloat* vertices, size_t vertexCount, GLfloat* normals);
+
+// Inverse transpose of the upper 3x3 of model, which keeps normals perpendicular under non-uniform scaling.
+// Rotations combined with per-axis scales, which covers every transform in the maze, take a fast path with
+// one divide per column (one for all three under uniform scale); anything else falls back to the cofactors.
+glm::mat3 NormalMatrix(const glm::mat4& model);
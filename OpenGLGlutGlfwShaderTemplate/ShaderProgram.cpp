@@ -0,0 +1,103 @@
+#include <iostream>
+#include <vector>
+
+#include "ShaderProgram.h"
+#include "prepShader.h"
+
+static bool compiled(GLuint shaderId, const char* file)
+{
+	GLint success = 0;
+	glGetShaderiv(shaderId, GL_COMPILE_STATUS, &success);
+	if (success != 0)
+		return true;
+	char temp[1024];
+	glGetShaderInfoLog(shaderId, 1024, 0, temp);
+	fprintf(stderr, "Failed to compile %s:\n%s\n", file, temp);
+	return false;
+}
+
+bool ShaderProgram::build(const char* vertexFile, const char* fragmentFile, const char* sharedFragmentFile)
+{
+	GLuint vertexShaderId = setShader((char*)"vertex", (char*)vertexFile);
+	GLuint fragmentShaderId = setShader((char*)"fragment", (char*)fragmentFile, sharedFragmentFile);
+	bool ok = compiled(vertexShaderId, vertexFile) && compiled(fragmentShaderId, fragmentFile);
+
+	m_program = GLProgram::create();
+	glAttachShader(m_program.get(), vertexShaderId);
+	glAttachShader(m_program.get(), fragmentShaderId);
+	glLinkProgram(m_program.get());
+	// The linked program keeps its own copy of the code, so the shader objects can go.
+	glDetachShader(m_program.get(), vertexShaderId);
+	glDetachShader(m_program.get(), fragmentShaderId);
+	glDeleteShader(vertexShaderId);
+	glDeleteShader(fragmentShaderId);
+
+	GLint success;
+	glGetProgramiv(m_program.get(), GL_LINK_STATUS, &success);
+	if (!ok || success == 0) {
+		char temp[1024];
+		glGetProgramInfoLog(m_program.get(), 1024, 0, temp);
+		fprintf(stderr, "Failed to link program:\n%s\n", temp);
+		release();
+		return false;
+	}
+
+	glValidateProgram(m_program.get());
+	glGetProgramiv(m_program.get(), GL_VALIDATE_STATUS, &success);
+	if (success == 0) {
+		char temp[1024];
+		glGetProgramInfoLog(m_program.get(), 1024, 0, temp);
+		fprintf(stderr, "Invalid Shader program:\n%s\n", temp);
+		release();
+		return false;
+	}
+
+	readUniforms();
+	return true;
+}
+
+void ShaderProgram::release()
+{
+	m_program.reset();
+	m_uniforms.clear();
+}
+
+void ShaderProgram::readUniforms()
+{
+	m_uniforms.clear();
+	GLint count = 0, maxLength = 0;
+	glGetProgramiv(m_program.get(), GL_ACTIVE_UNIFORMS, &count);
+	glGetProgramiv(m_program.get(), GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+	std::vector<GLchar> buffer(maxLength + 1);
+	for (GLint i = 0; i < count; i++)
+	{
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(m_program.get(), i, buffer.size(), &length, &size, &type, buffer.data());
+		std::string name(buffer.data(), length);
+		GLint location = glGetUniformLocation(m_program.get(), name.c_str());
+		// Members of uniform blocks have no location of their own.
+		if (location < 0)
+			continue;
+		m_uniforms[name] = { location, type };
+
+		// Arrays of basic types are reported once as "name[0]". Register the bare name and every element too.
+		if (size > 1 && name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+		{
+			std::string base = name.substr(0, name.size() - 3);
+			m_uniforms[base] = { location, type };
+			for (GLint element = 1; element < size; element++)
+			{
+				std::string elementName = base + "[" + std::to_string(element) + "]";
+				m_uniforms[elementName] = { glGetUniformLocation(m_program.get(), elementName.c_str()), type };
+			}
+		}
+	}
+}
+
+GLint ShaderProgram::location(const std::string& name) const
+{
+	auto it = m_uniforms.find(name);
+	return it == m_uniforms.end() ? -1 : it->second.location;
+}
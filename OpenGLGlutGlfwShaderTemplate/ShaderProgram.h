@@ -0,0 +1,122 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+#include "GLHandle.h"
+
+// How a C++ type is uploaded, and which GLSL types it may be bound to.
+template <typename T>
+struct UniformTraits;
+
+template <>
+struct UniformTraits<GLfloat>
+{
+	static bool Accepts(GLenum type) { return type == GL_FLOAT; }
+	static void Upload(GLint location, const GLfloat& value) { glUniform1f(location, value); }
+};
+
+template <>
+struct UniformTraits<GLint>
+{
+	static bool Accepts(GLenum type) { return type == GL_INT || type == GL_SAMPLER_2D || type == GL_SAMPLER_2D_ARRAY || type == GL_SAMPLER_2D_SHADOW || type == GL_SAMPLER_2D_ARRAY_SHADOW; }
+	static void Upload(GLint location, const GLint& value) { glUniform1i(location, value); }
+};
+
+template <>
+struct UniformTraits<bool>
+{
+	static bool Accepts(GLenum type) { return type == GL_BOOL; }
+	static void Upload(GLint location, const bool& value) { glUniform1i(location, value ? GL_TRUE : GL_FALSE); }
+};
+
+template <>
+struct UniformTraits<glm::vec3>
+{
+	static bool Accepts(GLenum type) { return type == GL_FLOAT_VEC3; }
+	static void Upload(GLint location, const glm::vec3& value) { glUniform3fv(location, 1, &value[0]); }
+};
+
+template <>
+struct UniformTraits<glm::vec4>
+{
+	static bool Accepts(GLenum type) { return type == GL_FLOAT_VEC4; }
+	static void Upload(GLint location, const glm::vec4& value) { glUniform4fv(location, 1, &value[0]); }
+};
+
+template <>
+struct UniformTraits<glm::mat4>
+{
+	static bool Accepts(GLenum type) { return type == GL_FLOAT_MAT4; }
+	static void Upload(GLint location, const glm::mat4& value) { glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]); }
+};
+
+// A uniform location resolved once at link time. Setting it is a single glUniform call, with no name lookup.
+template <typename T>
+class Uniform
+{
+public:
+	Uniform() {}
+	explicit Uniform(GLint location) : m_location(location) {}
+
+	void set(const T& value) const
+	{
+		if (m_location >= 0)
+			UniformTraits<T>::Upload(m_location, value);
+	}
+	GLint location() const { return m_location; }
+
+private:
+	GLint m_location = -1;
+};
+
+// A linked program plus a table of every active uniform, built by enumerating GL_ACTIVE_UNIFORMS after linking.
+class ShaderProgram
+{
+public:
+	// Compiles both stages with setShader, links them and fills the uniform table. Prints the log and returns false on failure.
+	// sharedFragmentFile, if given, is compiled into the fragment stage ahead of fragmentFile's own code.
+	bool build(const char* vertexFile, const char* fragmentFile, const char* sharedFragmentFile = nullptr);
+	void use() const { GLState::UseProgram(m_program.get()); }
+	GLuint id() const { return m_program.get(); }
+	void release();
+
+	// Location from the table, or -1 if the program has no such active uniform. Meant for setup code only;
+	// per-frame code should keep the Uniform handle instead.
+	GLint location(const std::string& name) const;
+	template <typename T>
+	Uniform<T> uniform(const std::string& name) const;
+	size_t uniformCount() const { return m_uniforms.size(); }
+
+private:
+	struct UniformInfo
+	{
+		GLint location;
+		GLenum type;
+	};
+
+	void readUniforms();
+
+	GLProgram m_program;
+	std::unordered_map<std::string, UniformInfo> m_uniforms;
+};
+
+template <typename T>
+Uniform<T> ShaderProgram::uniform(const std::string& name) const
+{
+	auto it = m_uniforms.find(name);
+	if (it == m_uniforms.end())
+	{
+		std::cout << "Uniform " << name << " is not active, writes to it are ignored." << std::endl;
+		return Uniform<T>();
+	}
+	if (!UniformTraits<T>::Accepts(it->second.type))
+	{
+		std::cout << "Uniform " << name << " does not match the requested type!!! " << std::endl;
+		return Uniform<T>();
+	}
+	return Uniform<T>(it->second.location);
+}
@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "ShadowCascades.h"
+
+// Extra width a camera-following cascade covers on each side, relative to its slice's bounding sphere.
+// The camera can move this far before the cascade has to be rendered again.
+static const float CASCADE_SLACK = 0.25f;
+// Blend between uniform (0) and logarithmic (1) cascade splits.
+static const float CASCADE_SPLIT_LAMBDA = 0.75f;
+
+ShadowCascades::ShadowCascades(int resolution)
+	: m_resolution(resolution)
+{
+	m_cascades[SHADOW_CASCADES - 1].policy = CASCADE_WHOLE_SCENE;
+}
+
+void ShadowCascades::create()
+{
+	m_depthArray = GLTexture::create();
+	GLState::ActiveTexture(GL_TEXTURE0 + SHADOW_MAP_UNIT);
+	GLState::BindTexture(GL_TEXTURE_2D_ARRAY, m_depthArray.get());
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_DEPTH_COMPONENT32F, m_resolution, m_resolution, SHADOW_CASCADES);
+	// Linear filtering plus depth compare gives 2x2 PCF per tap for free.
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	// Outside the map counts as lit.
+	const GLfloat border[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+	glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+	// Stays bound to its own unit for good, so nothing else has to rebind it.
+	GLState::ActiveTexture(GL_TEXTURE0);
+
+	m_framebuffer = GLFramebuffer::create();
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer.get());
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	m_paramsBuffer = GLBuffer::create();
+	GLState::BindBuffer(GL_UNIFORM_BUFFER, m_paramsBuffer.get());
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(GpuShadowParams), nullptr, GL_DYNAMIC_DRAW);
+	GLState::BindBuffer(GL_UNIFORM_BUFFER, 0);
+	GLState::BindBufferBase(GL_UNIFORM_BUFFER, SHADOW_BLOCK_BINDING, m_paramsBuffer.get());
+	Shape::BufferCount()++;
+
+	for (Cascade& cascade : m_cascades)
+		cascade.dirty = true;
+	m_paramsDirty = true;
+}
+
+void ShadowCascades::release()
+{
+	m_depthArray.reset();
+	m_framebuffer.reset();
+	m_paramsBuffer.reset();
+}
+
+void ShadowCascades::setProjection(float fovY, float aspect, float zNear, float zFar)
+{
+	m_fovY = fovY;
+	m_aspect = aspect;
+	m_near = zNear;
+	m_far = zFar;
+	fitSlices();
+}
+
+void ShadowCascades::setSceneBounds(const Aabb& bounds)
+{
+	m_scene = bounds;
+	// Forces update to refit the light-space depth range.
+	m_towardLight = glm::vec3(0.0f);
+}
+
+void ShadowCascades::fitSlices()
+{
+	// Squared half diagonal of the frustum's cross-section, per unit of depth squared.
+	float tanY = tanf(m_fovY * 0.5f);
+	float k = tanY * tanY * (m_aspect * m_aspect + 1.0f);
+	float start = m_near;
+	for (int i = 0; i < SHADOW_CASCADES; i++)
+	{
+		Cascade& cascade = m_cascades[i];
+		float t = (float)(i + 1) / SHADOW_CASCADES;
+		float logSplit = m_near * powf(m_far / m_near, t);
+		float uniformSplit = m_near + (m_far - m_near) * t;
+		float end = CASCADE_SPLIT_LAMBDA * logSplit + (1.0f - CASCADE_SPLIT_LAMBDA) * uniformSplit;
+		// The sphere through the near and far corners of the slice, centered on the view axis.
+		float center = std::min((start + end) * (1.0f + k) * 0.5f, end);
+		float nearRadius2 = (center - start) * (center - start) + start * start * k;
+		float farRadius2 = (end - center) * (end - center) + end * end * k;
+		cascade.end = end;
+		cascade.sliceCenter = center;
+		cascade.radius = sqrtf(std::max(nearRadius2, farRadius2));
+		cascade.dirty = true;
+		start = end;
+	}
+	m_paramsDirty = true;
+}
+
+void ShadowCascades::update(const glm::mat4& view, glm::vec3 towardLight)
+{
+	if (!m_paramsBuffer)
+		return;
+	glm::vec3 direction = glm::normalize(towardLight);
+	if (direction != m_towardLight)
+	{
+		m_towardLight = direction;
+		glm::vec3 up = fabsf(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+		m_lightView = glm::lookAt(glm::vec3(0.0f), -direction, up);
+		// Every cascade spans the whole scene in depth, so casters outside the camera's view still cast.
+		float minZ = 0.0f, maxZ = 0.0f;
+		for (int corner = 0; corner < 8; corner++)
+		{
+			glm::vec3 point((corner & 1) ? m_scene.max.x : m_scene.min.x,
+				(corner & 2) ? m_scene.max.y : m_scene.min.y,
+				(corner & 4) ? m_scene.max.z : m_scene.min.z);
+			float z = (m_lightView * glm::vec4(point, 1.0f)).z;
+			minZ = corner == 0 ? z : std::min(minZ, z);
+			maxZ = corner == 0 ? z : std::max(maxZ, z);
+		}
+		m_lightNear = -maxZ - 1.0f;
+		m_lightFar = -minZ + 1.0f;
+		for (Cascade& cascade : m_cascades)
+			cascade.dirty = true;
+	}
+
+	glm::mat4 inverseView = glm::inverse(view);
+	glm::vec3 eye(inverseView[3]);
+	glm::vec3 forward = -glm::vec3(inverseView[2]);
+	glm::vec3 sceneCenter = (m_scene.min + m_scene.max) * 0.5f;
+	for (Cascade& cascade : m_cascades)
+	{
+		glm::vec3 worldCenter = eye + forward * cascade.sliceCenter;
+		float radius = cascade.radius;
+		if (cascade.policy == CASCADE_WHOLE_SCENE)
+		{
+			// Depends on the light and the scene alone, both of which mark it dirty when they change.
+			if (!cascade.dirty)
+				continue;
+			worldCenter = sceneCenter;
+			radius = glm::length(m_scene.max - sceneCenter);
+		}
+		glm::vec2 lightCenter(m_lightView * glm::vec4(worldCenter, 1.0f));
+		if (!cascade.dirty)
+		{
+			// Still valid while the sphere fits inside the square the cached map covers.
+			glm::vec2 offset = glm::abs(lightCenter - cascade.center);
+			if (std::max(offset.x, offset.y) + radius <= cascade.halfSize)
+				continue;
+			cascade.dirty = true;
+		}
+		fit(cascade, lightCenter, radius);
+	}
+	if (m_paramsDirty)
+		upload();
+}
+
+void ShadowCascades::fit(Cascade& cascade, glm::vec2 lightCenter, float radius)
+{
+	if (cascade.policy == CASCADE_FOLLOW_CAMERA)
+		cascade.halfSize = radius * (1.0f + CASCADE_SLACK);
+	else
+		cascade.halfSize = radius * m_resolution / (m_resolution - 2); // One texel of room for the snap below.
+	// Whole texels only, so a re-rendered map lines up with the old one instead of shimmering.
+	float texel = 2.0f * cascade.halfSize / m_resolution;
+	cascade.center = glm::floor(lightCenter / texel) * texel;
+	glm::mat4 projection = glm::ortho(cascade.center.x - cascade.halfSize, cascade.center.x + cascade.halfSize,
+		cascade.center.y - cascade.halfSize, cascade.center.y + cascade.halfSize, m_lightNear, m_lightFar);
+	cascade.viewProjection = projection * m_lightView;
+	m_paramsDirty = true;
+}
+
+void ShadowCascades::upload()
+{
+	// Clip space to texture space.
+	glm::mat4 bias(0.5f);
+	bias[3] = glm::vec4(0.5f, 0.5f, 0.5f, 1.0f);
+	GpuShadowParams params = {};
+	for (int i = 0; i < SHADOW_CASCADES; i++)
+	{
+		params.shadowMatrices[i] = bias * m_cascades[i].viewProjection;
+		params.cascadeEnds[i] = m_cascades[i].end;
+	}
+	params.texelSize = 1.0f / m_resolution;
+	params.enabled = 1.0f;
+	GLState::BindBuffer(GL_UNIFORM_BUFFER, m_paramsBuffer.get());
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(params), &params);
+	GLState::BindBuffer(GL_UNIFORM_BUFFER, 0);
+	Shape::UploadedBytes() += sizeof(params);
+	m_paramsDirty = false;
+}
+
+void ShadowCascades::beginCascade(int cascade)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer.get());
+	glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, m_depthArray.get(), 0, cascade);
+	glViewport(0, 0, m_resolution, m_resolution);
+	glClear(GL_DEPTH_BUFFER_BIT);
+	// Back faces only, pushed a little further away, keeps lit faces from shadowing themselves.
+	glCullFace(GL_FRONT);
+	GLState::Enable(GL_POLYGON_OFFSET_FILL);
+	glPolygonOffset(1.0f, 2.0f);
+	m_cascades[cascade].dirty = false;
+	m_renderCount++;
+}
+
+void ShadowCascades::endCascades(int width, int height)
+{
+	GLState::Disable(GL_POLYGON_OFFSET_FILL);
+	glCullFace(GL_BACK);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, width, height);
+}
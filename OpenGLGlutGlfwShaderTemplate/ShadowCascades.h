@@ -0,0 +1,98 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "GLHandle.h"
+#include "Shape.h"
+
+// Number of cascades. Matches SHADOW_CASCADES in lighting.glsl.
+#define SHADOW_CASCADES 3
+// Uniform block binding of the Shadows block, and the texture unit shadowMap samples from. Both match lighting.glsl.
+#define SHADOW_BLOCK_BINDING 2
+#define SHADOW_MAP_UNIT 4
+
+// std140 mirror of the Shadows block.
+struct GpuShadowParams
+{
+	glm::mat4 shadowMatrices[SHADOW_CASCADES]; // World space to shadow map texture coordinates and depth.
+	GLfloat cascadeEnds[4]; // View depth where each cascade ends.
+	GLfloat texelSize; // 1 / shadow map size, for the PCF taps.
+	GLfloat enabled;
+	GLfloat pad[2];
+};
+
+static_assert(sizeof(GpuShadowParams) == SHADOW_CASCADES * 64 + 32, "GpuShadowParams does not match std140");
+
+// How a cascade decides its cached shadow map is out of date.
+enum CascadePolicy
+{
+	// Fitted to a slice of the camera frustum, with some slack. Re-rendered once the slice leaves the
+	// area the cached map covers, or when the light turns.
+	CASCADE_FOLLOW_CAMERA,
+	// Covers the whole static scene. Only re-rendered when the light turns.
+	CASCADE_WHOLE_SCENE
+};
+
+// Cascaded shadow maps for the directional light, one layer of a depth texture array per cascade.
+// The scene is static, so a cascade's map stays valid until its light-space box moves or the light
+// turns. In a steady frame nothing is rendered or uploaded.
+class ShadowCascades
+{
+public:
+	explicit ShadowCascades(int resolution = 2048);
+
+	void create();
+	void release();
+	// Must match the camera projection. Cascades split [zNear, zFar] and the last one ends at zFar.
+	void setProjection(float fovY, float aspect, float zNear, float zFar);
+	// World-space box around every shadow caster. Invalidates every cascade.
+	void setSceneBounds(const Aabb& bounds);
+
+	// Refits the cascades to the camera and marks the ones whose cached map no longer covers their slice.
+	// towardLight is DirectionalLight::direction, pointing from the scene to the light.
+	void update(const glm::mat4& view, glm::vec3 towardLight);
+	bool isDirty(int cascade) const { return m_cascades[cascade].dirty; }
+	// Targets the depth layer of a dirty cascade and clears it. Draw the casters with viewProjection(cascade) after.
+	void beginCascade(int cascade);
+	const glm::mat4& viewProjection(int cascade) const { return m_cascades[cascade].viewProjection; }
+	// Goes back to the window framebuffer with the given viewport.
+	void endCascades(int width, int height);
+
+	void setPolicy(int cascade, CascadePolicy policy) { m_cascades[cascade].policy = policy; m_cascades[cascade].dirty = true; }
+	// Cascade maps rendered since the counter was last reset. Zero in steady frames.
+	int& renderCount() { return m_renderCount; }
+
+private:
+	struct Cascade
+	{
+		CascadePolicy policy = CASCADE_FOLLOW_CAMERA;
+		float end = 0.0f; // View depth the cascade ends at.
+		float radius = 0.0f; // Of the bounding sphere around the cascade's frustum slice, which does not depend on where the camera looks.
+		float sliceCenter = 0.0f; // Depth of that sphere's center along the view direction.
+		glm::vec2 center; // Light-space center the cached map covers.
+		float halfSize = 0.0f; // Half the width of the area the cached map covers.
+		glm::mat4 viewProjection;
+		bool dirty = true;
+	};
+
+	void fitSlices();
+	void fit(Cascade& cascade, glm::vec2 lightCenter, float radius);
+	void upload();
+
+	int m_resolution;
+	float m_fovY = 0.785f, m_aspect = 1.0f, m_near = 0.1f, m_far = 100.0f;
+	Aabb m_scene = { glm::vec3(-1.0f), glm::vec3(1.0f) };
+	glm::vec3 m_towardLight;
+	glm::mat4 m_lightView;
+	// Light-space depth range that holds the whole scene.
+	float m_lightNear = 0.0f, m_lightFar = 1.0f;
+	Cascade m_cascades[SHADOW_CASCADES];
+	bool m_paramsDirty = true;
+	int m_renderCount = 0;
+
+	GLTexture m_depthArray;
+	GLFramebuffer m_framebuffer;
+	GLBuffer m_paramsBuffer;
+
+};
@@ -3,25 +3,162 @@
 #include <GL/glew.h>
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <unordered_map>
 #include <cmath>
+#include <cstddef>
+#include "GLHandle.h"
+#include "Normals.h"
+#include "LightmapBaker.h"
 #define PI 3.14159265358979324
 using namespace std;
 
+// One interleaved vertex. Everything the vertex shader reads sits next to each other in a single VBO.
+struct Vertex
+{
+	glm::vec3 position;
+	glm::vec3 color;
+	glm::vec2 uv;
+	glm::vec3 normal;
+};
+
+// Describes where one shader attribute lives inside Vertex.
+struct VertexAttribute
+{
+	GLuint location;
+	GLint size;
+	GLenum type;
+	size_t offset;
+};
+
+// Matches the layout(location = N) inputs of directional.vert.
+static const VertexAttribute VERTEX_LAYOUT[] = {
+	{ 0, 3, GL_FLOAT, offsetof(Vertex, position) },
+	{ 1, 3, GL_FLOAT, offsetof(Vertex, color) },
+	{ 2, 2, GL_FLOAT, offsetof(Vertex, uv) },
+	{ 3, 3, GL_FLOAT, offsetof(Vertex, normal) }
+};
+
+// Most point lights one object is lit by in the per-object light mode. Matches the ivec4 object_lights input.
+#define MAX_OBJECT_LIGHTS 4
+
+// Indices into the point light buffer, most relevant first. Unused slots are -1.
+struct ObjectLights
+{
+	GLint index[MAX_OBJECT_LIGHTS];
+};
+
+static const ObjectLights NO_OBJECT_LIGHTS = { { -1, -1, -1, -1 } };
+
+// Location of the object_lights input of directional.vert. Fed per instance, per baked vertex,
+// or as a constant attribute for single draws.
+static const GLuint OBJECT_LIGHTS_LOCATION = 9;
+
+// Location of the vertex_lightmap input of directional.vert. Only baked meshes with a lightmap feed it.
+static const GLuint LIGHTMAP_UV_LOCATION = 13;
+
+// Location of the draw_index input of directional.vert and shadow.vert. Only MeshArena feeds it.
+static const GLuint DRAW_INDEX_LOCATION = 14;
+
+// Axis-aligned bounding box.
+struct Aabb
+{
+	glm::vec3 min;
+	glm::vec3 max;
+};
+
+// Per-instance data for instanced draws, read once per instance instead of once per vertex.
+struct InstanceData
+{
+	glm::mat4 model;
+	glm::vec3 color;
+	ObjectLights lights;
+	glm::mat3 normalMatrix; // NormalMatrix(model), so the vertex shader never inverts anything.
+};
+
+// Vertex buffer binding point the instance buffer gets attached to.
+static const GLuint INSTANCE_BINDING = 8;
+
+// Matches the instance_* inputs of directional.vert. Matrices take one location per column.
+static const VertexAttribute INSTANCE_LAYOUT[] = {
+	{ 4, 4, GL_FLOAT, offsetof(InstanceData, model) },
+	{ 5, 4, GL_FLOAT, offsetof(InstanceData, model) + sizeof(glm::vec4) },
+	{ 6, 4, GL_FLOAT, offsetof(InstanceData, model) + sizeof(glm::vec4) * 2 },
+	{ 7, 4, GL_FLOAT, offsetof(InstanceData, model) + sizeof(glm::vec4) * 3 },
+	{ 8, 3, GL_FLOAT, offsetof(InstanceData, color) },
+	{ OBJECT_LIGHTS_LOCATION, 4, GL_INT, offsetof(InstanceData, lights) },
+	{ 10, 3, GL_FLOAT, offsetof(InstanceData, normalMatrix) },
+	{ 11, 3, GL_FLOAT, offsetof(InstanceData, normalMatrix) + sizeof(glm::vec3) },
+	{ 12, 3, GL_FLOAT, offsetof(InstanceData, normalMatrix) + sizeof(glm::vec3) * 2 }
+};
+
 struct Shape
 {
 protected:
-	vector<GLshort> shape_indices;
+	// Always 32-bit on the CPU. BufferShape narrows them to 16-bit on the GPU when the mesh allows it.
+	vector<GLuint> shape_indices;
+	GLenum shape_indexType = GL_UNSIGNED_SHORT;
+	// Per-attribute arrays the generators fill in. Interleave() packs them into shape_data and releases them.
 	vector<GLfloat> shape_vertices;
 	vector<GLfloat> shape_colors;
 	vector<GLfloat> shape_uvs;
 	vector<GLfloat> shape_normals;
-	GLuint vao, ibo, points_vbo, colors_vbo, uv_vbo, normals_vbo;
+	vector<Vertex> shape_data;
+	glm::vec3 shape_color{1.0f, 1.0f, 1.0f};
+	Aabb shape_bounds = { glm::vec3(0.0f), glm::vec3(0.0f) };
+	// Owned GL objects. Shape is move-only, so two Shapes can never share (and double-delete) them.
+	GLVertexArray vao;
+	GLBuffer ibo, vbo;
 
 public:
-	~Shape()
+	// Number of GL buffer objects created by BufferShape so far.
+	static GLuint& BufferCount()
+	{
+		static GLuint count = 0;
+		return count;
+	}
+	// Bytes sent to GL buffers since the counter was last reset. display() resets it every frame.
+	static size_t& UploadedBytes()
 	{
-		shape_indices.clear();
-		shape_indices.shrink_to_fit();
+		static size_t bytes = 0;
+		return bytes;
+	}
+	// Draw calls issued since the counter was last reset. display() resets it every frame.
+	static GLuint& DrawCount()
+	{
+		static GLuint count = 0;
+		return count;
+	}
+	GLsizei NumIndices() { return shape_indices.size(); }
+	// CPU copies of the mesh, valid once Interleave, Prepare or BufferShape has run.
+	const vector<Vertex>& Vertices() const { return shape_data; }
+	const vector<GLuint>& Indices() const { return shape_indices; }
+	// Local-space bounds, valid once Prepare or BufferShape has run.
+	const Aabb& Bounds() const { return shape_bounds; }
+	// Smallest GL index type that can address every vertex of this mesh.
+	GLenum IndexType() { return NumVertices() <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT; }
+	GLsizei NumVertices() { return shape_data.empty() ? shape_vertices.size() / 3 : shape_data.size(); }
+	void Interleave()
+	{
+		if (!shape_data.empty())
+			return;
+		unsigned count = shape_vertices.size() / 3;
+		shape_data.resize(count);
+		for (unsigned i = 0; i < count; i++)
+		{
+			Vertex& v = shape_data[i];
+			v.position = glm::vec3(shape_vertices[i * 3], shape_vertices[i * 3 + 1], shape_vertices[i * 3 + 2]);
+			v.color = glm::vec3(1.0f, 1.0f, 1.0f);
+			if (i * 3 + 2 < shape_colors.size())
+				v.color = glm::vec3(shape_colors[i * 3], shape_colors[i * 3 + 1], shape_colors[i * 3 + 2]);
+			v.uv = glm::vec2(0.0f, 0.0f);
+			if (i * 2 + 1 < shape_uvs.size())
+				v.uv = glm::vec2(shape_uvs[i * 2], shape_uvs[i * 2 + 1]);
+			v.normal = glm::vec3(0.0f, 0.0f, 0.0f);
+			if (i * 3 + 2 < shape_normals.size())
+				v.normal = glm::vec3(shape_normals[i * 3], shape_normals[i * 3 + 1], shape_normals[i * 3 + 2]);
+		}
+		// The interleaved copy is the only one we need from here on.
 		shape_vertices.clear();
 		shape_vertices.shrink_to_fit();
 		shape_colors.clear();
@@ -31,98 +168,126 @@ public:
 		shape_normals.clear();
 		shape_normals.shrink_to_fit();
 	}
-	GLsizei NumIndices() { return shape_indices.size(); }
+	// Everything BufferShape does short of GL, for meshes that are only ever read on the CPU.
+	void Prepare()
+	{
+		Interleave();
+		if (!shape_data.empty())
+		{
+			shape_bounds.min = shape_bounds.max = shape_data[0].position;
+			for (const Vertex& v : shape_data)
+			{
+				shape_bounds.min = glm::min(shape_bounds.min, v.position);
+				shape_bounds.max = glm::max(shape_bounds.max, v.position);
+			}
+		}
+	}
 	void BufferShape()
 	{
-		vao = 0;
-		glGenVertexArrays(1, &vao);
-		glBindVertexArray(vao);
-
-		ibo = 0;
-		glGenBuffers(1, &ibo);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(shape_indices[0]) * shape_indices.size(), &shape_indices.front(), GL_STATIC_DRAW);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-		points_vbo = 0;
-		glGenBuffers(1, &points_vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, points_vbo);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(shape_vertices[0]) * shape_vertices.size(), &shape_vertices.front(), GL_STATIC_DRAW);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(shape_vertices[0]) * 3, 0);
-		glEnableVertexAttribArray(0);
-
-		colors_vbo = 0;
-		glGenBuffers(1, &colors_vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, colors_vbo);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(shape_colors[0]) * shape_colors.size(), &shape_colors.front(), GL_STATIC_DRAW);
-		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, 0);
-		glEnableVertexAttribArray(1);
-
-		uv_vbo = 0;
-		glGenBuffers(1, &uv_vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, uv_vbo);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(shape_uvs[0]) * shape_uvs.size(), &shape_uvs.front(), GL_STATIC_DRAW);
-		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, 0);
-		glEnableVertexAttribArray(2);
-
-		// Uncomment for DirectionalLight example.
-		normals_vbo = 0;
-		glGenBuffers(1, &normals_vbo);
-		glBindBuffer(GL_ARRAY_BUFFER, normals_vbo);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(shape_normals[0]) * shape_normals.size(), &shape_normals.front(), GL_STATIC_DRAW);
-		glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 0, 0);
-		glEnableVertexAttribArray(3);
-
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-		glBindVertexArray(0); // Can optionally unbind the vertex array to avoid modification.
+		Prepare();
+
+		vao = GLVertexArray::create();
+		GLState::BindVertexArray(vao.get());
+
+		ibo = GLBuffer::create();
+		GLState::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo.get());
+		shape_indexType = IndexType();
+		size_t indexBytes;
+		if (shape_indexType == GL_UNSIGNED_SHORT)
+		{
+			vector<GLushort> shortIndices(shape_indices.begin(), shape_indices.end());
+			indexBytes = sizeof(GLushort) * shortIndices.size();
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, shortIndices.data(), GL_STATIC_DRAW);
+		}
+		else
+		{
+			indexBytes = sizeof(GLuint) * shape_indices.size();
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, shape_indices.data(), GL_STATIC_DRAW);
+		}
+
+		vbo = GLBuffer::create();
+		GLState::BindBuffer(GL_ARRAY_BUFFER, vbo.get());
+		glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * shape_data.size(), shape_data.data(), GL_STATIC_DRAW);
+		for (const VertexAttribute& attrib : VERTEX_LAYOUT)
+		{
+			glVertexAttribPointer(attrib.location, attrib.size, attrib.type, GL_FALSE, sizeof(Vertex), (const void*)attrib.offset);
+			glEnableVertexAttribArray(attrib.location);
+		}
+		BufferCount() += 2;
+		UploadedBytes() += indexBytes + sizeof(Vertex) * shape_data.size();
+
+		// Instance attributes only get their format here. They stay disabled until DrawShapeInstanced.
+		for (const VertexAttribute& attrib : INSTANCE_LAYOUT)
+		{
+			if (attrib.type == GL_INT)
+				glVertexAttribIFormat(attrib.location, attrib.size, attrib.type, attrib.offset);
+			else
+				glVertexAttribFormat(attrib.location, attrib.size, attrib.type, GL_FALSE, attrib.offset);
+			glVertexAttribBinding(attrib.location, INSTANCE_BINDING);
+		}
+		glVertexBindingDivisor(INSTANCE_BINDING, 1);
+
+		GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+
+		GLState::BindVertexArray(0); // Can optionally unbind the vertex array to avoid modification.
 	}
+	// Bakes a new vertex color into the buffer. Only re-uploads when the color actually changes;
+	// per-draw tints should go through the tint uniform or InstanceData::color instead.
 	void RecolorShape(GLfloat r, GLfloat g, GLfloat b)
 	{
+		if (glm::vec3(r, g, b) == shape_color)
+			return;
 		ColorShape(r, g, b);
-		glBindBuffer(GL_ARRAY_BUFFER, colors_vbo);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(shape_colors[0]) * shape_colors.size(), &shape_colors.front(), GL_STATIC_DRAW);
+		GLState::BindBuffer(GL_ARRAY_BUFFER, vbo.get());
+		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Vertex) * shape_data.size(), shape_data.data());
+		UploadedBytes() += sizeof(Vertex) * shape_data.size();
 	}
 	void DrawShape(GLchar c)
 	{
-		glBindVertexArray(vao);
-		glDrawElements(c, this->NumIndices(), GL_UNSIGNED_SHORT, 0);
-		glBindVertexArray(0);
+		GLState::BindVertexArray(vao.get());
+		glDrawElements(c, this->NumIndices(), shape_indexType, 0);
+		DrawCount()++;
 	}
-	void CalcAverageNormals(vector<GLshort>& indices, unsigned indiceCount, vector<GLfloat>& vertices, unsigned verticeCount)
+	// Draws instanceCount copies, reading InstanceData from instanceBuffer starting at offset bytes.
+	void DrawShapeInstanced(GLenum mode, GLuint instanceBuffer, GLintptr offset, GLsizei instanceCount)
 	{
-		// Popular shape_normals so we can use [].
-		for (int i = 0; i < verticeCount; i++)
-			shape_normals.push_back(0);
-		shape_normals.shrink_to_fit();
-		// Calculate the normals of each triangle first.
-		for (unsigned i = 0; i < indiceCount; i += 3)
-		{
-			unsigned in0 = indices[i] * 3;
-			unsigned in1 = indices[i + 1] * 3;
-			unsigned in2 = indices[i + 2] * 3;
-			glm::vec3 v1(vertices[in1] - vertices[in0], vertices[in1 + 1] - vertices[in0 + 1], vertices[in1 + 2] - vertices[in0 + 2]);
-			glm::vec3 v2(vertices[in2] - vertices[in0], vertices[in2 + 1] - vertices[in0 + 1], vertices[in2 + 2] - vertices[in0 + 2]);
-			glm::vec3 normal = glm::cross(v1, v2);
-			normal = glm::normalize(normal); // Finally becomes a unit vector.
-
-			// Now populate the normal values for each vertex of the triangle.
-			shape_normals[in0] += normal.x;	shape_normals[in0 + 1] += normal.y;	shape_normals[in0 + 2] += normal.z;
-			shape_normals[in1] += normal.x;	shape_normals[in1 + 1] += normal.y;	shape_normals[in1 + 2] += normal.z;
-			shape_normals[in2] += normal.x;	shape_normals[in2 + 1] += normal.y;	shape_normals[in2 + 2] += normal.z;
-		}
-		// Normalize each of the new normal vectors.
-		for (unsigned i = 0; i < shape_normals.size(); i += 3)
-		{
-			glm::vec3 vec(shape_normals[i], shape_normals[i + 1], shape_normals[i + 2]);
-			vec = glm::normalize(vec);
-			shape_normals[i] = vec.x; shape_normals[i + 1] = vec.y; shape_normals[i + 2] = vec.z;
-		}
+		GLState::BindVertexArray(vao.get());
+		glBindVertexBuffer(INSTANCE_BINDING, instanceBuffer, offset, sizeof(InstanceData));
+		for (const VertexAttribute& attrib : INSTANCE_LAYOUT)
+			glEnableVertexAttribArray(attrib.location);
+		glDrawElementsInstanced(mode, this->NumIndices(), shape_indexType, 0, instanceCount);
+		DrawCount()++;
+		for (const VertexAttribute& attrib : INSTANCE_LAYOUT)
+			glDisableVertexAttribArray(attrib.location);
+	}
+	// Issues drawCount DrawElementsIndirectCommands read from commandBuffer at offset bytes, in one call.
+	void DrawShapeIndirect(GLenum mode, GLuint commandBuffer, GLintptr offset, GLsizei drawCount)
+	{
+		GLState::BindVertexArray(vao.get());
+		GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+		glMultiDrawElementsIndirect(mode, shape_indexType, (const void*)offset, drawCount, 0);
+		DrawCount()++;
+		GLState::BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+	// Deletes the GL objects but keeps the CPU mesh, so BufferShape can upload it again.
+	void ReleaseBuffers()
+	{
+		vao.reset();
+		ibo.reset();
+		vbo.reset();
+	}
+	void CalcAverageNormals(vector<GLuint>& indices, unsigned indiceCount, vector<GLfloat>& vertices, unsigned verticeCount)
+	{
+		shape_normals.assign(verticeCount, 0.0f);
+		ComputeVertexNormals(indices.data(), indiceCount, vertices.data(), verticeCount / 3, shape_normals.data());
 	}
 
 protected:
 	void ColorShape(GLfloat r, GLfloat g, GLfloat b)
 	{
+		shape_color = glm::vec3(r, g, b);
+		for (unsigned i = 0; i < shape_data.size(); i++)
+			shape_data[i].color = glm::vec3(r, g, b);
 		shape_colors.clear();
 		shape_colors.shrink_to_fit();
 		for (int i = 0; i < shape_vertices.size(); i += 3)
@@ -137,101 +302,113 @@ protected:
 
 
 
-struct Sphere : public Shape
+struct Sphere : public Shape // Unit icosphere centred on the origin.
 {
-
 	Sphere(int subdivision)
 	{
+		// Start from an icosahedron: 12 vertices, 20 faces.
+		const float t = (1.0f + sqrt(5.0f)) / 2.0f;
+		const glm::vec3 corners[12] = {
+			glm::vec3(-1, t, 0), glm::vec3(1, t, 0), glm::vec3(-1, -t, 0), glm::vec3(1, -t, 0),
+			glm::vec3(0, -1, t), glm::vec3(0, 1, t), glm::vec3(0, -1, -t), glm::vec3(0, 1, -t),
+			glm::vec3(t, 0, -1), glm::vec3(t, 0, 1), glm::vec3(-t, 0, -1), glm::vec3(-t, 0, 1)
+		};
+		for (const glm::vec3& corner : corners)
+			addVertex(corner);
+		shape_indices = {
+			0, 11, 5,	0, 5, 1,	0, 1, 7,	0, 7, 10,	0, 10, 11,
+			1, 5, 9,	5, 11, 4,	11, 10, 2,	10, 7, 6,	7, 1, 8,
+			3, 9, 4,	3, 4, 2,	3, 2, 6,	3, 6, 8,	3, 8, 9,
+			4, 9, 5,	2, 4, 11,	6, 2, 10,	8, 6, 7,	9, 8, 1
+		};
 
-		const int Ndivisions = subdivision;
-		const int NumTetrahedrons = pow(4.0, subdivision); // example: 4^5 = 1024 tetrahedrons
-		const int NumTriangles = 4 * NumTetrahedrons;  // 4 triangles / tetrahedron
-		const int NumVertices = 3 * NumTriangles;      // 3 vertices / triangle
-
-		glm::vec3 v[4];
-		v[0] = glm::vec3(0.0, 0.0, -1.0);
-		v[1] = glm::vec3(0.0, 0.942809, 0.333333);
-		v[2] = glm::vec3(-0.816497, -0.471405, 0.333333);
-		v[3] = glm::vec3(0.816497, -0.471405, 0.333333);
-
-
-		tetra(v[0], v[1], v[2], v[3], Ndivisions);
-		int j = 0;
-
-		for (int i = 0; i < NumVertices; ++i) {
-			shape_indices.push_back(i);
+		// Every level splits each triangle into four. Edge midpoints go through a cache so the
+		// two triangles sharing an edge also share the new vertex.
+		for (int level = 0; level < subdivision; level++)
+		{
+			unordered_map<unsigned long long, GLuint> midpoints;
+			vector<GLuint> faces;
+			faces.reserve(shape_indices.size() * 4);
+			for (unsigned i = 0; i < shape_indices.size(); i += 3)
+			{
+				GLuint a = shape_indices[i], b = shape_indices[i + 1], c = shape_indices[i + 2];
+				GLuint ab = midpoint(a, b, midpoints);
+				GLuint bc = midpoint(b, c, midpoints);
+				GLuint ca = midpoint(c, a, midpoints);
+				faces.insert(faces.end(), { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca });
+			}
+			shape_indices.swap(faces);
 		}
 
-		for (int i = 0; i < shape_vertices.size(); i++)
+		// On a unit sphere the normal is the position. Uvs are a plain longitude/latitude mapping.
+		shape_normals = shape_vertices;
+		for (unsigned i = 0; i < shape_vertices.size(); i += 3)
 		{
-			shape_uvs.push_back(0);
-			shape_uvs.push_back(0);
-			shape_uvs.push_back(0);
-			shape_uvs.push_back(1);
-			shape_uvs.push_back(1);
-			shape_uvs.push_back(0);
+			shape_uvs.push_back(0.5f + atan2(shape_vertices[i + 2], shape_vertices[i]) / (2.0f * PI));
+			shape_uvs.push_back(0.5f + asin(shape_vertices[i + 1]) / PI);
 		}
+		fixSeam();
 
 		ColorShape(1.0f, 1.0f, 0.0f);
 	}
 
-	void triangle(glm::vec3& a, glm::vec3& b, glm::vec3& c)
-		/* specify one triangle */
+private:
+	GLuint addVertex(glm::vec3 v)
 	{
-
-		shape_vertices.push_back(a[0]);
-		shape_vertices.push_back(a[1]);
-		shape_vertices.push_back(a[2]);
-
-		shape_normals.push_back(a[0]);
-		shape_normals.push_back(a[1]);
-		shape_normals.push_back(a[2]);
-		shape_normals.push_back(0.0);
-
-		shape_vertices.push_back(b[0]);
-		shape_vertices.push_back(b[1]);
-		shape_vertices.push_back(b[2]);
-
-		shape_normals.push_back(b[0]);
-		shape_normals.push_back(b[1]);
-		shape_normals.push_back(b[2]);
-		shape_normals.push_back(0.0);
-
-		shape_vertices.push_back(c[0]);
-		shape_vertices.push_back(c[1]);
-		shape_vertices.push_back(c[2]);
-
-		shape_normals.push_back(c[0]);
-		shape_normals.push_back(c[1]);
-		shape_normals.push_back(c[2]);
-		shape_normals.push_back(0.0);
+		v = glm::normalize(v);
+		shape_vertices.push_back(v.x);
+		shape_vertices.push_back(v.y);
+		shape_vertices.push_back(v.z);
+		return shape_vertices.size() / 3 - 1;
 	}
 
-	void divide_triangle(glm::vec3 a, glm::vec3 b, glm::vec3 c, int k)
+	GLuint midpoint(GLuint a, GLuint b, unordered_map<unsigned long long, GLuint>& cache)
 	{
-		if (k > 0)
-		{
-			// compute midpoints of sides
-			glm::vec3 ab = glm::normalize((a + b) / 2.0f);
-			glm::vec3 ac = glm::normalize((a + c) / 2.0f);
-			glm::vec3 bc = glm::normalize((b + c) / 2.0f);
-			// subdivide all but inner triangle
-			divide_triangle(a, ab, ac, k - 1);
-			divide_triangle(ab, b, bc, k - 1);
-			divide_triangle(bc, c, ac, k - 1);
-			divide_triangle(ab, bc, ac, k - 1);
-		}
-		else triangle(a, b, c); /* draw triangle at end of recursion */
+		unsigned long long key = a < b ? ((unsigned long long)a << 32) | b : ((unsigned long long)b << 32) | a;
+		auto found = cache.find(key);
+		if (found != cache.end())
+			return found->second;
+		glm::vec3 va(shape_vertices[a * 3], shape_vertices[a * 3 + 1], shape_vertices[a * 3 + 2]);
+		glm::vec3 vb(shape_vertices[b * 3], shape_vertices[b * 3 + 1], shape_vertices[b * 3 + 2]);
+		GLuint index = addVertex((va + vb) / 2.0f);
+		cache[key] = index;
+		return index;
 	}
 
-	void tetra(glm::vec3& a, glm::vec3& b, glm::vec3& c, glm::vec3& d, int n)
+	// Triangles straddling the u = 0/1 seam would interpolate across the whole texture.
+	// Give them copies of their low-u vertices with u shifted past 1 instead.
+	void fixSeam()
 	{
-		divide_triangle(a, b, c, n);
-		divide_triangle(a, c, d, n);
-		divide_triangle(a, d, b, n);
-		divide_triangle(b, d, c, n);
+		unordered_map<GLuint, GLuint> wrapped;
+		for (unsigned i = 0; i < shape_indices.size(); i += 3)
+		{
+			float u0 = shape_uvs[shape_indices[i] * 2];
+			float u1 = shape_uvs[shape_indices[i + 1] * 2];
+			float u2 = shape_uvs[shape_indices[i + 2] * 2];
+			if (fmax(u0, fmax(u1, u2)) - fmin(u0, fmin(u1, u2)) < 0.5f)
+				continue;
+			for (unsigned j = i; j < i + 3; j++)
+			{
+				GLuint index = shape_indices[j];
+				if (shape_uvs[index * 2] >= 0.5f)
+					continue;
+				auto found = wrapped.find(index);
+				if (found == wrapped.end())
+				{
+					GLuint copy = shape_vertices.size() / 3;
+					for (int k = 0; k < 3; k++)
+					{
+						shape_vertices.push_back(shape_vertices[index * 3 + k]);
+						shape_normals.push_back(shape_normals[index * 3 + k]);
+					}
+					shape_uvs.push_back(shape_uvs[index * 2] + 1.0f);
+					shape_uvs.push_back(shape_uvs[index * 2 + 1]);
+					found = wrapped.insert({ index, copy }).first;
+				}
+				shape_indices[j] = found->second;
+			}
+		}
 	}
-
 };
 
 struct Plane : public Shape // Vertical plane of 1x1 units across.
@@ -549,4 +726,167 @@ struct Cone : public Shape
 		ColorShape(1.0f, 1.0f, 1.0f);
 		CalcAverageNormals(shape_indices, shape_indices.size(), shape_vertices, shape_vertices.size());
 	}
+};
+
+struct BakedShape : public Shape // Other shapes pre-transformed into world space and merged into one mesh.
+{
+	// One appended shape: its vertex range and world-space bounds. Lights are assigned per piece.
+	struct Piece
+	{
+		GLuint firstVertex;
+		GLuint vertexCount;
+		Aabb bounds;
+	};
+
+	void Append(const Shape& shape, const glm::mat4& model, glm::vec3 tint = glm::vec3(1.0f, 1.0f, 1.0f))
+	{
+		GLuint base = shape_data.size();
+		glm::mat3 normalMatrix = NormalMatrix(model);
+		Piece piece = { base, (GLuint)shape.Vertices().size(), { glm::vec3(0.0f), glm::vec3(0.0f) } };
+		for (const Vertex& v : shape.Vertices())
+		{
+			Vertex baked = v;
+			baked.position = glm::vec3(model * glm::vec4(v.position, 1.0f));
+			baked.normal = glm::normalize(normalMatrix * v.normal);
+			baked.color = v.color * tint;
+			if (shape_data.size() == base)
+				piece.bounds.min = piece.bounds.max = baked.position;
+			piece.bounds.min = glm::min(piece.bounds.min, baked.position);
+			piece.bounds.max = glm::max(piece.bounds.max, baked.position);
+			shape_data.push_back(baked);
+		}
+		for (GLuint index : shape.Indices())
+			shape_indices.push_back(base + index);
+		baked_pieces.push_back(piece);
+	}
+	const vector<Piece>& Pieces() const { return baked_pieces; }
+	// Copy of the mesh for LightmapBaker.
+	LightmapMesh MakeLightmapMesh() const
+	{
+		LightmapMesh mesh;
+		for (const Vertex& v : shape_data)
+		{
+			mesh.positions.push_back(v.position);
+			mesh.normals.push_back(v.normal);
+		}
+		mesh.indices.assign(shape_indices.begin(), shape_indices.end());
+		return mesh;
+	}
+	// Switches to the vertices LightmapBaker::unwrap split the mesh into, and keeps their lightmap uvs. Call before BufferShape.
+	void SetLightmap(const LightmapMesh& mesh)
+	{
+		vector<Vertex> vertices(mesh.remap.size());
+		for (size_t i = 0; i < vertices.size(); i++)
+			vertices[i] = shape_data[mesh.remap[i]];
+		// remap is sorted, so the copies of each piece's vertices are still one range.
+		for (Piece& piece : baked_pieces)
+		{
+			auto first = std::lower_bound(mesh.remap.begin(), mesh.remap.end(), piece.firstVertex);
+			auto last = std::lower_bound(first, mesh.remap.end(), piece.firstVertex + piece.vertexCount);
+			piece.firstVertex = first - mesh.remap.begin();
+			piece.vertexCount = last - first;
+		}
+		shape_data.swap(vertices);
+		shape_indices.assign(mesh.indices.begin(), mesh.indices.end());
+		lightmap_uvs = mesh.lightmapUvs;
+	}
+	// Adds the lightmap uvs to the vertex array BufferShape made. Does nothing without SetLightmap.
+	void BufferLightmap()
+	{
+		if (lightmap_uvs.empty())
+			return;
+		size_t bytes = sizeof(glm::vec2) * lightmap_uvs.size();
+		lightmap_vbo = GLBuffer::create();
+		BufferCount()++;
+		GLState::BindVertexArray(vao.get());
+		GLState::BindBuffer(GL_ARRAY_BUFFER, lightmap_vbo.get());
+		glBufferData(GL_ARRAY_BUFFER, bytes, lightmap_uvs.data(), GL_STATIC_DRAW);
+		glVertexAttribPointer(LIGHTMAP_UV_LOCATION, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), 0);
+		glEnableVertexAttribArray(LIGHTMAP_UV_LOCATION);
+		GLState::BindVertexArray(0);
+		GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+		UploadedBytes() += bytes;
+	}
+	// Writes one light list per piece into every vertex of that piece, as the object_lights attribute.
+	void SetPieceLights(const vector<ObjectLights>& pieceLights)
+	{
+		vector<ObjectLights> vertexLights(shape_data.size(), NO_OBJECT_LIGHTS);
+		for (size_t i = 0; i < baked_pieces.size(); i++)
+		{
+			const Piece& piece = baked_pieces[i];
+			std::fill(vertexLights.begin() + piece.firstVertex, vertexLights.begin() + piece.firstVertex + piece.vertexCount, pieceLights[i]);
+		}
+		size_t bytes = sizeof(ObjectLights) * vertexLights.size();
+		if (!light_vbo)
+		{
+			light_vbo = GLBuffer::create();
+			BufferCount()++;
+			GLState::BindVertexArray(vao.get());
+			GLState::BindBuffer(GL_ARRAY_BUFFER, light_vbo.get());
+			glBufferData(GL_ARRAY_BUFFER, bytes, vertexLights.data(), GL_DYNAMIC_DRAW);
+			glVertexAttribIPointer(OBJECT_LIGHTS_LOCATION, MAX_OBJECT_LIGHTS, GL_INT, sizeof(ObjectLights), 0);
+			glEnableVertexAttribArray(OBJECT_LIGHTS_LOCATION);
+			GLState::BindVertexArray(0);
+		}
+		else
+		{
+			GLState::BindBuffer(GL_ARRAY_BUFFER, light_vbo.get());
+			glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, vertexLights.data());
+		}
+		GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+		UploadedBytes() += bytes;
+	}
+
+private:
+	vector<Piece> baked_pieces;
+	GLBuffer light_vbo;
+	vector<glm::vec2> lightmap_uvs;
+	GLBuffer lightmap_vbo;
+};
+
+struct MeshArena : public Shape // Unrelated meshes in one vertex and index buffer, so one multi-draw can reach all of them.
+{
+	// Where an added mesh sits, in the terms of DrawElementsIndirectCommand.
+	struct Range
+	{
+		GLuint firstIndex;
+		GLuint indexCount;
+		GLint baseVertex;
+	};
+
+	// Copies mesh in untransformed. Its indices stay local; baseVertex points them at its vertices.
+	Range Add(const Shape& mesh)
+	{
+		Range range = { (GLuint)shape_indices.size(), (GLuint)mesh.Indices().size(), (GLint)shape_data.size() };
+		shape_data.insert(shape_data.end(), mesh.Vertices().begin(), mesh.Vertices().end());
+		shape_indices.insert(shape_indices.end(), mesh.Indices().begin(), mesh.Indices().end());
+		return range;
+	}
+	// Feeds draw_index from a buffer holding 0, 1, 2 ... count - 1, one value per instance. An instance of a
+	// command reads value baseInstance + gl_InstanceID, which is how it finds its DrawData without gl_BaseInstance.
+	// Call after BufferShape.
+	void BufferDrawIndices(GLuint count)
+	{
+		vector<GLuint> indices(count);
+		for (GLuint i = 0; i < count; i++)
+			indices[i] = i;
+		size_t bytes = sizeof(GLuint) * indices.size();
+		if (!draw_index_vbo)
+		{
+			draw_index_vbo = GLBuffer::create();
+			BufferCount()++;
+		}
+		GLState::BindVertexArray(vao.get());
+		GLState::BindBuffer(GL_ARRAY_BUFFER, draw_index_vbo.get());
+		glBufferData(GL_ARRAY_BUFFER, bytes, indices.data(), GL_STATIC_DRAW);
+		glVertexAttribIPointer(DRAW_INDEX_LOCATION, 1, GL_UNSIGNED_INT, sizeof(GLuint), 0);
+		glVertexAttribDivisor(DRAW_INDEX_LOCATION, 1);
+		glEnableVertexAttribArray(DRAW_INDEX_LOCATION);
+		GLState::BindVertexArray(0);
+		GLState::BindBuffer(GL_ARRAY_BUFFER, 0);
+		UploadedBytes() += bytes;
+	}
+
+private:
+	GLBuffer draw_index_vbo;
 };
\ No newline at end of file
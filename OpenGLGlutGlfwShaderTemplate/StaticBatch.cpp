@@ -0,0 +1,50 @@
+#include "StaticBatch.h"
+
+BakedShape& StaticBatch::batchFor(const Material* material)
+{
+	for (auto& batch : m_batches)
+	{
+		if (batch.first == material)
+			return *batch.second;
+	}
+	m_batches.push_back({ material, std::unique_ptr<BakedShape>(new BakedShape()) });
+	return *m_batches.back().second;
+}
+
+void StaticBatch::add(MazeShape& group, glm::vec3 position, const Material* material)
+{
+	group.appendTo(batchFor(material), position);
+}
+
+void StaticBatch::add(const Shape& shape, const glm::mat4& model, const Material* material)
+{
+	batchFor(material).Append(shape, model);
+}
+
+bool StaticBatch::unwrapLightmap(LightmapBaker& baker)
+{
+	m_lightmapMeshes.clear();
+	m_lightmapMeshes.reserve(m_batches.size());
+	for (auto& batch : m_batches)
+	{
+		m_lightmapMeshes.push_back(batch.second->MakeLightmapMesh());
+		baker.add(&m_lightmapMeshes.back());
+	}
+	if (!baker.unwrap())
+		return false;
+	for (size_t i = 0; i < m_batches.size(); i++)
+		m_batches[i].second->SetLightmap(m_lightmapMeshes[i]);
+	return true;
+}
+
+Aabb StaticBatch::bounds() const
+{
+	Aabb bounds = { glm::vec3(0.0f), glm::vec3(0.0f) };
+	for (size_t i = 0; i < m_batches.size(); i++)
+	{
+		const Aabb& batchBounds = m_batches[i].second->Bounds();
+		bounds.min = i == 0 ? batchBounds.min : glm::min(bounds.min, batchBounds.min);
+		bounds.max = i == 0 ? batchBounds.max : glm::max(bounds.max, batchBounds.max);
+	}
+	return bounds;
+}
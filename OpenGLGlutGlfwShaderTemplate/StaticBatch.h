@@ -0,0 +1,58 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+#include "DrawQueue.h"
+#include "LightBuffer.h"
+#include "LightmapBaker.h"
+#include "Material.h"
+#include "MazeShape.h"
+#include "Shape.h"
+
+// Bakes static geometry into one world-space mesh per material, so each material costs a single draw.
+// Everything that buffers or draws is in StaticBatchDraw.cpp, so LightmapBake can unwrap a batch without the renderer.
+class StaticBatch
+{
+public:
+	// Assigns point and spot lights per baked piece for the per-object light mode, again whenever lightBuffer reports a change.
+	void setLights(const std::vector<PointLight>* lights, const std::vector<SpotLight>* spots, const LightBuffer* lightBuffer) {
+		m_lights = lights;
+		m_spots = spots;
+		m_lightBuffer = lightBuffer;
+	}
+	void add(MazeShape& group, glm::vec3 position, const Material* material);
+	void add(const Shape& shape, const glm::mat4& model, const Material* material);
+	// Unwraps every batch into baker's atlas and gives it lightmap uvs. Call after the last add and before build.
+	// The batch keeps the unwrapped meshes until clear, for LightmapBaker::bake to read.
+	bool unwrapLightmap(LightmapBaker& baker);
+	// Uploads every batch. Call once after the last add.
+	void build();
+	// Queues one draw per batch for pass.
+	void submit(DrawQueue& queue, unsigned pass);
+	// World-space box around every baked mesh. Only valid after build.
+	Aabb bounds() const;
+	// Deletes every baked mesh.
+	void clear() {
+		m_batches.clear();
+		m_lightmapMeshes.clear();
+		m_lightsAssigned = false;
+	}
+
+private:
+	BakedShape& batchFor(const Material* material);
+	void updateLights();
+
+	const std::vector<PointLight>* m_lights = nullptr;
+	const std::vector<SpotLight>* m_spots = nullptr;
+	const LightBuffer* m_lightBuffer = nullptr;
+	unsigned m_lightVersion = 0;
+	bool m_lightsAssigned = false;
+	// Kept in the order materials were first added. DrawQueue decides the draw order.
+	std::vector<std::pair<const Material*, std::unique_ptr<BakedShape>>> m_batches;
+	// Parallel to m_batches once unwrapLightmap has run.
+	std::vector<LightmapMesh> m_lightmapMeshes;
+
+};
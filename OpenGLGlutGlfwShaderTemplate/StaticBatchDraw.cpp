@@ -0,0 +1,42 @@
+#include "StaticBatch.h"
+#include "LightAssignment.h"
+
+void StaticBatch::build()
+{
+	for (auto& batch : m_batches)
+	{
+		batch.second->BufferShape();
+		batch.second->BufferLightmap();
+	}
+}
+
+void StaticBatch::updateLights()
+{
+	if (m_lights == nullptr || m_spots == nullptr || m_lightBuffer == nullptr)
+		return;
+	if (m_lightsAssigned && m_lightBuffer->version() == m_lightVersion)
+		return;
+	m_lightsAssigned = true;
+	m_lightVersion = m_lightBuffer->version();
+	for (auto& batch : m_batches)
+	{
+		// Pieces are already in world space.
+		const std::vector<BakedShape::Piece>& pieces = batch.second->Pieces();
+		std::vector<ObjectLights> pieceLights(pieces.size());
+		for (size_t i = 0; i < pieces.size(); i++)
+			pieceLights[i] = AssignLights(pieces[i].bounds, *m_lights, *m_spots);
+		batch.second->SetPieceLights(pieceLights);
+	}
+}
+
+void StaticBatch::submit(DrawQueue& queue, unsigned pass)
+{
+	updateLights();
+	// Vertices are already in world space, and every piece carries its own lights.
+	for (auto& batch : m_batches)
+	{
+		const Aabb& bounds = batch.second->Bounds();
+		queue.submit(pass, { batch.first, batch.second.get(), nullptr, nullptr, glm::vec3(1.0f, 1.0f, 1.0f), NO_OBJECT_LIGHTS,
+			0, 0, 0, (bounds.min + bounds.max) * 0.5f });
+	}
+}
@@ -40,23 +40,48 @@ bool Texture::Load()
     cout << "The number of my GPU texture units: " << textureUnits;
 
     //!Generate a handler for texture object
-    glGenTextures(1, &m_textureObj);
+    m_textureObj = GLTexture::create();
     //!This tells openGL if the texture object is 1D, 2D, 3D, etc..
-    glBindTexture(m_textureTarget, m_textureObj);
+    //!Edited on unit 0, since Bind may have left any unit active.
+    GLState::ActiveTexture(GL_TEXTURE0);
+    GLState::BindTexture(m_textureTarget, m_textureObj.get());
     glTexImage2D(GL_TEXTURE_2D, 0, m_format, twidth, theight, 0, m_format, GL_UNSIGNED_BYTE,image);
+    stbi_image_free(image);
 
     	//! Configure the texture state
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::BindTexture(GL_TEXTURE_2D, 0);
+
+    return true;
+}
+
+bool Texture::LoadHdr()
+{
+    stbi_set_flip_vertically_on_load(true);
+    float* image = stbi_loadf(m_fileName.c_str(), &twidth, &theight, &tbitDepth, 3);
+    if (!image)
+        return false;
+
+    m_textureObj = GLTexture::create();
+    GLState::ActiveTexture(GL_TEXTURE0);
+    GLState::BindTexture(m_textureTarget, m_textureObj.get());
+    glTexImage2D(GL_TEXTURE_2D, 0, m_format, twidth, theight, 0, GL_RGB, GL_FLOAT, image);
+    stbi_image_free(image);
+
+    // Lightmap charts are padded, not tiled, so never wrap.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    GLState::BindTexture(GL_TEXTURE_2D, 0);
 
     return true;
 }
 
 void Texture::Bind(GLenum TextureUnit)
 {
-    glActiveTexture(TextureUnit);
-    glBindTexture(m_textureTarget, m_textureObj);
+    GLState::BindTextureUnit(TextureUnit, m_textureTarget, m_textureObj.get());
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <GL/glew.h>
+#include "GLHandle.h"
 //#define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
@@ -10,13 +11,15 @@ public:
     Texture(GLenum TextureTarget, const std::string& FileName, GLint Format);
 
     bool Load();
+    // Loads a Radiance .hdr file as floats, for formats like GL_RGB16F. Returns false instead of exiting when the file is missing.
+    bool LoadHdr();
 
     void Bind(GLenum TextureUnit);
 
 private:
     std::string m_fileName;
     GLenum m_textureTarget;
-    GLuint m_textureObj;
+    GLTexture m_textureObj;
     GLint m_format;
 };
 
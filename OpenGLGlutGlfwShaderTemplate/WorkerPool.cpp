@@ -0,0 +1,77 @@
+#include "WorkerPool.h"
+
+#include <iostream>
+
+void WorkerPool::start(int threads)
+{
+	stop();
+	if (threads <= 0)
+		threads = (int)std::thread::hardware_concurrency() - 1;
+	m_stopping = false;
+	for (int i = 0; i < threads; i++)
+		m_threads.emplace_back(&WorkerPool::work, this, m_generation);
+	std::cout << "Worker pool of " << m_threads.size() << " threads besides the GL thread." << std::endl;
+}
+
+void WorkerPool::stop()
+{
+	if (m_threads.empty())
+		return;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_wake.notify_all();
+	for (std::thread& thread : m_threads)
+		thread.join();
+	m_threads.clear();
+}
+
+void WorkerPool::run(int count, const std::function<void(int)>& job)
+{
+	// Waking the workers costs more than a single job saves.
+	if (m_threads.empty() || count < 2)
+	{
+		for (int i = 0; i < count; i++)
+			job(i);
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_job = &job;
+		m_count = count;
+		m_next = 0;
+		m_busy = m_threads.size();
+		m_generation++;
+	}
+	m_wake.notify_all();
+	for (int i = m_next++; i < count; i = m_next++)
+		job(i);
+	// Every worker has to check in, even one that found nothing left, so none can still be reading m_job.
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_done.wait(lock, [this] { return m_busy == 0; });
+	m_job = nullptr;
+}
+
+void WorkerPool::work(unsigned generation)
+{
+	for (;;)
+	{
+		const std::function<void(int)>* job;
+		int count;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [this, generation] { return m_stopping || m_generation != generation; });
+			if (m_stopping)
+				return;
+			generation = m_generation;
+			job = m_job;
+			count = m_count;
+		}
+		for (int i = m_next++; i < count; i = m_next++)
+			(*job)(i);
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (--m_busy == 0)
+			m_done.notify_one();
+	}
+}
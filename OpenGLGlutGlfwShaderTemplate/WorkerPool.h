@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Threads that stay parked between frames and split a batch of independent jobs with the calling thread.
+// Jobs must not touch GL: the context is only current on the thread that created it.
+class WorkerPool
+{
+public:
+	WorkerPool() {}
+	~WorkerPool() { stop(); }
+
+	// Starts threads workers. 0 takes one per hardware thread, minus the caller, which works on every run too.
+	void start(int threads = 0);
+	// Joins the workers. run keeps working afterwards, on the calling thread alone.
+	void stop();
+	// Calls job(i) for every i in [0, count), spread over the workers and the calling thread, and returns once
+	// all of them are done. Which thread runs which i, and in what order, is up to whichever is free first.
+	void run(int count, const std::function<void(int)>& job);
+
+	int threads() const { return m_threads.size(); }
+
+private:
+	// generation is the run that was current when the worker started, which it must not join.
+	void work(unsigned generation);
+
+	std::vector<std::thread> m_threads;
+	std::mutex m_mutex;
+	std::condition_variable m_wake, m_done;
+	// The current run. m_generation changes with every run, so a worker can tell a new one from the one it just did.
+	const std::function<void(int)>* m_job = nullptr;
+	int m_count = 0;
+	std::atomic<int> m_next{ 0 };
+	unsigned m_generation = 0;
+	int m_busy = 0; // Workers that haven't finished the current run.
+	bool m_stopping = false;
+
+};
@@ -0,0 +1,45 @@
+#version 430 core
+
+// Lighting pass of the deferred mode. Applies the same lights as directional.frag, from lighting.glsl, once per covered pixel.
+
+in vec2 screenUV;
+out vec4 frag_color;
+
+// Units are GBUFFER_ALBEDO_UNIT, GBUFFER_NORMAL_UNIT and GBUFFER_DEPTH_UNIT in GBuffer.h.
+layout(binding = 1) uniform sampler2D gAlbedo;
+layout(binding = 2) uniform sampler2D gNormal;
+layout(binding = 3) uniform sampler2D gDepth;
+
+uniform int lightMode; // Which point lights each pixel loops over. Per-object lists and lightmap uvs are not stored, so both fall back to clusters.
+
+void main()
+{
+	float depth = texture(gDepth, screenUV).r;
+	if (depth == 1.0f)
+		discard; // Nothing was drawn here.
+	vec4 worldPos = inverseViewProjection * vec4(vec3(screenUV, depth) * 2.0f - 1.0f, 1.0f);
+	vec3 fragPos = worldPos.xyz / worldPos.w;
+	vec4 albedo = texture(gAlbedo, screenUV);
+	vec4 normalShininess = texture(gNormal, screenUV);
+	// Material values come from the alpha channels of the G-buffer.
+	Surface surface = Surface(fragPos, normalShininess.xyz, -(view * vec4(fragPos, 1.0f)).z, Material(albedo.a, normalShininess.a));
+
+	vec4 calcColor = vec4(0.0f);
+	calcColor += calcAmbientLight(aLight.base);
+	calcColor += calcDirectionalLight(surface) * calcShadow(surface);
+	if (lightMode == LIGHTS_ALL)
+	{
+		for (uint i = 0u; i < pointLightCount; i++)
+			calcColor += calcPointLight(surface, pLights[i]);
+		for (uint i = 0u; i < spotLightCount; i++)
+			calcColor += calcSpotLight(surface, sLights[i]);
+	}
+	else
+	{
+		uvec2 range = clusterRanges[clusterIndex(surface)];
+		for (uint i = range.x; i < range.x + range.y; i++)
+			calcColor += calcLight(surface, clusterLights[i]);
+	}
+
+	frag_color = vec4(albedo.rgb, 1.0f) * calcColor;
+}
\ No newline at end of file
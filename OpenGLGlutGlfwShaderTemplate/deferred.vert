@@ -0,0 +1,11 @@
+#version 430 core
+
+// Lighting pass of the deferred mode: one triangle that covers the whole screen, with no vertex buffer.
+out vec2 screenUV;
+
+void main()
+{
+	vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+	screenUV = corner;
+	gl_Position = vec4(corner * 2.0f - 1.0f, 0.0f, 1.0f);
+}
\ No newline at end of file
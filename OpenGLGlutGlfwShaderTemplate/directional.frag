@@ -1,98 +1,33 @@
 #version 430 core
 
-#ifndef NUM_POINT_LIGHTS
-#define NUM_POINT_LIGHTS 5
-#endif
+// Forward lighting. The lights, the light blocks and the light functions come from lighting.glsl.
+
 in vec3 color;
 in vec2 texCoord;
 in vec3 normal;
 in vec3 fragPos;
+in float viewDepth;
+flat in ivec4 objectLights;
+in vec2 lightmapCoord;
 out vec4 frag_color;
 
-struct Light
-{
-	vec3 diffuseColor;
-	float diffuseStrength;
-};
-
-struct AmbientLight
-{
-	Light base;
-};
-
-struct DirectionalLight
-{
-	Light base;
-	vec3 direction;
-};
-
-struct PointLight
-{
-	Light base;
-	vec3 position;
-	float constant;
-	float linear;
-	float quadratic;
-};
-
-struct Material
-{
-	float specularStrength;
-	float shininess;
-};
+layout(binding = 0) uniform sampler2D texture0;
 
-uniform sampler2D texture0;
-uniform vec3 eyePosition;
-
-uniform AmbientLight aLight;
-uniform DirectionalLight dLight;
-uniform PointLight pLights[NUM_POINT_LIGHTS];
+uniform int lightMode; // Which point lights each fragment loops over.
+// Ambient, point and spot light baked by LightmapBaker. The first bakedPointLights point lights and
+// bakedSpotLights spot lights are in it, and LIGHTS_BAKED skips them in the cluster lists.
+layout(binding = 5) uniform sampler2D lightmap; // LIGHTMAP_UNIT.
+uniform int bakedPointLights;
+uniform int bakedSpotLights;
 uniform Material mat;
 
-vec4 calcAmbientLight(Light a)
+bool isBaked(uint index)
 {
-	vec4 ambient = vec4(a.diffuseColor, 1.0f) * a.diffuseStrength;
-	return ambient;
-}
-
-vec4 calcLightByDirection(Light l, vec3 dir)
-{
-	float diffuseFactor = max( dot( normalize(normal), normalize(dir) ), 0.0f);
-	vec4 diffuse = vec4(l.diffuseColor, 1.0f) * l.diffuseStrength * diffuseFactor;
-
-	vec4 specular = vec4(0,0,0,0);
-	if (diffuseFactor > 0.0f && l.diffuseStrength > 0.0f)
-	{
-		vec3 fragToEye = normalize(eyePosition - fragPos);
-		vec3 reflectedVertex = normalize(reflect(dir, normalize(normal)));
-
-		float specularFactor = dot(fragToEye, reflectedVertex);
-		if (specularFactor > 0.0f)
-		{
-			specularFactor = pow(specularFactor, mat.shininess);
-			specular = vec4(l.diffuseColor * mat.specularStrength * specularFactor, 1.0f);
-		}
-	}
-	return (diffuse + specular);
-}
-
-vec4 calcDirectionalLight()
-{
-	return calcLightByDirection(dLight.base, dLight.direction);
-}
-
-vec4 calcPointLight(PointLight p)
-{
-	vec3 direction = fragPos - p.position;
-	float distance = length(direction);
-	direction = normalize(direction);
-
-	vec4 color = calcLightByDirection(p.base, direction);
-	float attenuation = p.quadratic * distance * distance +
-		p.linear * distance +
-		p.constant;
-	//attenuation = 5.0;
-	return (color / attenuation);
+	if (lightMode != LIGHTS_BAKED)
+		return false;
+	if (index < pointLightCount)
+		return index < uint(bakedPointLights);
+	return index - pointLightCount < uint(bakedSpotLights);
 }
 
 //vec4 calcPointLight()
@@ -111,12 +46,38 @@ vec4 calcPointLight(PointLight p)
 
 void main()
 {
+	Surface surface = Surface(fragPos, normal, viewDepth, mat);
 	// Calculate lighting.
-	vec4 calcColor;
-	calcColor += calcAmbientLight(aLight.base);
-	calcColor += calcDirectionalLight();
-	for (int i = 0; i < NUM_POINT_LIGHTS; i++)
-		calcColor += calcPointLight(pLights[i]);
+	vec4 calcColor = vec4(0.0f);
+	if (lightMode == LIGHTS_BAKED)
+		calcColor += vec4(texture(lightmap, lightmapCoord).rgb, 1.0f);
+	else
+		calcColor += calcAmbientLight(aLight.base);
+	calcColor += calcDirectionalLight(surface) * calcShadow(surface);
+	if (lightMode == LIGHTS_CLUSTERED || lightMode == LIGHTS_BAKED)
+	{
+		uvec2 range = clusterRanges[clusterIndex(surface)];
+		for (uint i = range.x; i < range.x + range.y; i++)
+		{
+			if (!isBaked(clusterLights[i]))
+				calcColor += calcLight(surface, clusterLights[i]);
+		}
+	}
+	else if (lightMode == LIGHTS_PER_OBJECT)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			if (objectLights[i] >= 0)
+				calcColor += calcLight(surface, uint(objectLights[i]));
+		}
+	}
+	else
+	{
+		for (uint i = 0u; i < pointLightCount; i++)
+			calcColor += calcPointLight(surface, pLights[i]);
+		for (uint i = 0u; i < spotLightCount; i++)
+			calcColor += calcSpotLight(surface, sLights[i]);
+	}
 
 	frag_color = texture(texture0, texCoord) * vec4(color, 1.0f) * calcColor;
 }
\ No newline at end of file
@@ -4,23 +4,73 @@ layout(location = 0) in vec3 vertex_position;
 layout(location = 1) in vec3 vertex_color;
 layout(location = 2) in vec2 vertex_texture;
 layout(location = 3) in vec3 vertex_normal;
+// Per-instance attributes, only used when instanced is true.
+layout(location = 4) in mat4 instance_model;
+layout(location = 8) in vec3 instance_color;
+// Most relevant point lights for the per-object light mode. Per instance, per baked vertex, or constant per draw.
+layout(location = 9) in ivec4 object_lights;
+layout(location = 10) in mat3 instance_normal; // Normal matrix of instance_model, computed on the CPU.
+layout(location = 13) in vec2 vertex_lightmap; // Only fed by baked meshes with a lightmap.
+layout(location = 14) in uint draw_index; // Only fed by the mesh arena, for indirect draws.
 
 out vec3 color;
 out vec2 texCoord;
 out vec3 normal;
 out vec3 fragPos;
+out float viewDepth; // Distance along the view direction, used to pick the light cluster.
+out vec2 lightmapCoord;
+flat out ivec4 objectLights;
 
 // Values that stay constant for the whole mesh.
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform mat3 normalMatrix; // Inverse transpose of model, from NormalMatrix on the CPU.
+uniform bool instanced;
+uniform vec3 tint; // Per-draw tint for non-instanced draws.
+uniform bool indirect; // Everything per draw comes from draws[draw_index] instead.
+
+// Mirrored by GpuCamera in the main file. Written into the frame ring once per frame.
+layout(std140, binding = 3) uniform Camera
+{
+	mat4 view;
+	mat4 projection;
+	mat4 inverseViewProjection;
+	vec3 eyePosition;
+};
+
+// One record per instance of every indirect command. Mirrored by GpuDrawData in IndirectScene.h.
+struct DrawData
+{
+	mat4 model;
+	mat4 normalMatrix; // Only the upper 3x3 is used.
+	vec4 tint;
+	ivec4 lights;
+};
+
+layout(std430, binding = 4) readonly buffer Draws
+{
+	DrawData draws[];
+};
 
 void main()
 {
-	gl_Position = projection * view * model * vec4(vertex_position, 1.0f);
-	color = vertex_color;
+	mat4 world = instanced ? instance_model : model;
+	mat3 worldNormal = instanced ? instance_normal : normalMatrix;
+	vec3 drawTint = instanced ? instance_color : tint;
+	objectLights = object_lights;
+	if (indirect)
+	{
+		world = draws[draw_index].model;
+		worldNormal = mat3(draws[draw_index].normalMatrix);
+		drawTint = draws[draw_index].tint.rgb;
+		objectLights = draws[draw_index].lights;
+	}
+	vec4 viewPos = view * world * vec4(vertex_position, 1.0f);
+	gl_Position = projection * viewPos;
+	viewDepth = -viewPos.z;
+	color = vertex_color * drawTint;
 	texCoord = vertex_texture;
+	lightmapCoord = vertex_lightmap;
 	// normal = vertex_normal;
-	normal = mat3(transpose(inverse(model))) * vertex_normal; // Only needed if there's non-uniform scaling.
-	fragPos = (model * vec4(vertex_position, 1.0f)).xyz;
+	normal = worldNormal * vertex_normal;
+	fragPos = (world * vec4(vertex_position, 1.0f)).xyz;
 }
\ No newline at end of file
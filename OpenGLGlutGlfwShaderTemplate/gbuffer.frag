@@ -0,0 +1,25 @@
+#version 430 core
+
+// Geometry pass of the deferred mode. Runs after directional.vert and stores what the lighting pass needs.
+// The material rides along in the alpha channels, specular strength with the albedo and shininess with the normal.
+struct Material
+{
+	float specularStrength;
+	float shininess;
+};
+
+in vec3 color;
+in vec2 texCoord;
+in vec3 normal;
+
+layout(location = 0) out vec4 gAlbedo;
+layout(location = 1) out vec4 gNormal;
+
+layout(binding = 0) uniform sampler2D texture0;
+uniform Material mat;
+
+void main()
+{
+	gAlbedo = vec4(texture(texture0, texCoord).rgb * color, mat.specularStrength);
+	gNormal = vec4(normalize(normal), mat.shininess);
+}
\ No newline at end of file
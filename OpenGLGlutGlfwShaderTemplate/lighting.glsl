@@ -0,0 +1,232 @@
+// Light blocks and light functions shared by directional.frag and deferred.frag. Not a shader of its own:
+// ShaderProgram::build passes it to glShaderSource right after the #version line of those two.
+
+// Values of lightMode.
+#define LIGHTS_ALL 0
+#define LIGHTS_CLUSTERED 1
+#define LIGHTS_PER_OBJECT 2
+#define LIGHTS_BAKED 3
+
+struct Light
+{
+	vec3 diffuseColor;
+	float diffuseStrength;
+};
+
+struct AmbientLight
+{
+	Light base;
+};
+
+struct DirectionalLight
+{
+	Light base;
+	vec3 direction;
+};
+
+struct PointLight
+{
+	Light base;
+	vec3 position;
+	float constant;
+	float linear;
+	float quadratic;
+	float range;
+};
+
+struct SpotLight
+{
+	Light base;
+	vec3 position;
+	float range;
+	vec3 direction;
+	float edge; // Cosine of the half angle.
+	float constant;
+	float linear;
+	float quadratic;
+};
+
+struct Material
+{
+	float specularStrength;
+	float shininess;
+};
+
+// What the light functions need to know about the point being lit.
+struct Surface
+{
+	vec3 position; // World space.
+	vec3 normal;
+	float viewDepth;
+	Material mat;
+};
+
+// Mirrored by GpuCamera in the main file. Written into the frame ring once per frame.
+layout(std140, binding = 3) uniform Camera
+{
+	mat4 view;
+	mat4 projection;
+	mat4 inverseViewProjection;
+	vec3 eyePosition;
+};
+
+// Mirrored by GpuLightBlock in LightBuffer.h.
+layout(std140, binding = 0) uniform Lights
+{
+	AmbientLight aLight;
+	DirectionalLight dLight;
+	uint pointLightCount;
+	uint spotLightCount;
+};
+
+// Mirrored by GpuClusterParams in ClusterGrid.h.
+layout(std140, binding = 1) uniform ClusterParams
+{
+	uvec4 clusterCount; // Tiles in x, tiles in y, depth slices.
+	vec4 clusterScale; // Tiles per pixel in x and y, then the slice scale and bias for log(viewDepth).
+};
+
+layout(std430, binding = 0) readonly buffer PointLights
+{
+	PointLight pLights[];
+};
+
+layout(std430, binding = 3) readonly buffer SpotLights
+{
+	SpotLight sLights[];
+};
+
+// Offset into clusterLights and light count, per cluster.
+layout(std430, binding = 1) readonly buffer ClusterRanges
+{
+	uvec2 clusterRanges[];
+};
+
+layout(std430, binding = 2) readonly buffer ClusterLights
+{
+	uint clusterLights[]; // Spot lights come after the point lights, numbered from pointLightCount.
+};
+
+#define SHADOW_CASCADES 3
+
+// Mirrored by GpuShadowParams in ShadowCascades.h.
+layout(std140, binding = 2) uniform Shadows
+{
+	mat4 shadowMatrices[SHADOW_CASCADES]; // World space to shadow map coordinates and depth.
+	vec4 cascadeEnds; // View depth where each cascade ends.
+	float shadowTexelSize;
+	float shadowsEnabled;
+};
+
+layout(binding = 4) uniform sampler2DArrayShadow shadowMap; // One layer per cascade, on SHADOW_MAP_UNIT.
+
+vec4 calcAmbientLight(Light a)
+{
+	vec4 ambient = vec4(a.diffuseColor, 1.0f) * a.diffuseStrength;
+	return ambient;
+}
+
+vec4 calcLightByDirection(Surface surface, Light l, vec3 dir)
+{
+	float diffuseFactor = max( dot( normalize(surface.normal), normalize(dir) ), 0.0f);
+	vec4 diffuse = vec4(l.diffuseColor, 1.0f) * l.diffuseStrength * diffuseFactor;
+
+	vec4 specular = vec4(0,0,0,0);
+	if (diffuseFactor > 0.0f && l.diffuseStrength > 0.0f)
+	{
+		vec3 fragToEye = normalize(eyePosition - surface.position);
+		vec3 reflectedVertex = normalize(reflect(dir, normalize(surface.normal)));
+
+		float specularFactor = dot(fragToEye, reflectedVertex);
+		if (specularFactor > 0.0f)
+		{
+			specularFactor = pow(specularFactor, surface.mat.shininess);
+			specular = vec4(l.diffuseColor * surface.mat.specularStrength * specularFactor, 1.0f);
+		}
+	}
+	return (diffuse + specular);
+}
+
+vec4 calcDirectionalLight(Surface surface)
+{
+	return calcLightByDirection(surface, dLight.base, dLight.direction);
+}
+
+vec4 calcPointLight(Surface surface, PointLight p)
+{
+	vec3 direction = surface.position - p.position;
+	float distance = length(direction);
+	direction = normalize(direction);
+
+	vec4 color = calcLightByDirection(surface, p.base, direction);
+	float attenuation = p.quadratic * distance * distance +
+		p.linear * distance +
+		p.constant;
+	//attenuation = 5.0;
+	// Fade to exactly zero at the range, so culling lights by range leaves no visible edge.
+	float window = clamp(1.0f - pow(distance / p.range, 4.0f), 0.0f, 1.0f);
+	return (color / attenuation) * window * window;
+}
+
+vec4 calcSpotLight(Surface surface, SpotLight s)
+{
+	vec3 direction = surface.position - s.position;
+	float distance = length(direction);
+	direction = direction / distance;
+	// Most fragments are outside the cone, so skip all the shading for them.
+	float spotFactor = dot(direction, s.direction);
+	if (spotFactor <= s.edge || distance >= s.range)
+		return vec4(0.0f);
+
+	vec4 color = calcLightByDirection(surface, s.base, direction);
+	float attenuation = s.quadratic * distance * distance +
+		s.linear * distance +
+		s.constant;
+	float window = clamp(1.0f - pow(distance / s.range, 4.0f), 0.0f, 1.0f);
+	// Fade to zero towards the edge of the cone.
+	float cone = (spotFactor - s.edge) / (1.0f - s.edge);
+	return (color / attenuation) * window * window * cone;
+}
+
+// Point lights are numbered first, then spot lights.
+vec4 calcLight(Surface surface, uint index)
+{
+	if (index < pointLightCount)
+		return calcPointLight(surface, pLights[index]);
+	return calcSpotLight(surface, sLights[index - pointLightCount]);
+}
+
+// Fraction of the directional light that reaches the fragment, from a 3x3 PCF over its cascade.
+float calcShadow(Surface surface)
+{
+	if (shadowsEnabled == 0.0f)
+		return 1.0f;
+	int cascade = 0;
+	while (cascade < SHADOW_CASCADES && surface.viewDepth >= cascadeEnds[cascade])
+		cascade++;
+	if (cascade == SHADOW_CASCADES)
+		return 1.0f;
+
+	vec4 shadowPos = shadowMatrices[cascade] * vec4(surface.position, 1.0f);
+	// Beyond the far plane of the light counts as lit.
+	if (shadowPos.z >= 1.0f)
+		return 1.0f;
+	float lit = 0.0f;
+	for (int y = -1; y <= 1; y++)
+	{
+		for (int x = -1; x <= 1; x++)
+		{
+			vec2 uv = shadowPos.xy + vec2(x, y) * shadowTexelSize;
+			lit += texture(shadowMap, vec4(uv, float(cascade), shadowPos.z));
+		}
+	}
+	return lit / 9.0f;
+}
+
+uint clusterIndex(Surface surface)
+{
+	uvec2 tile = min(uvec2(gl_FragCoord.xy * clusterScale.xy), clusterCount.xy - 1u);
+	uint slice = uint(max(log(surface.viewDepth) * clusterScale.z + clusterScale.w, 0.0f));
+	slice = min(slice, clusterCount.z - 1u);
+	return tile.x + clusterCount.x * (tile.y + clusterCount.y * slice);
+}
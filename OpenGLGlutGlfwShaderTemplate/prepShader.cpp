@@ -1,6 +1,7 @@
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <cstring>
 
 #include <GL/glew.h>
 #include <GL/freeglut.h> 
@@ -25,21 +26,36 @@ char* readShader(std::string fileName)
    return fileContent;
 }
 
-// Function to initialize shaders.
-int setShader(char* shaderType, char* shaderFile)
+// Function to initialize shaders. sharedFile, if given, is compiled in right after the #version line of shaderFile,
+// so code used by several shaders lives in one place.
+int setShader(char* shaderType, char* shaderFile, const char* sharedFile)
 {
    int shaderId;
    char* shader = readShader(shaderFile);
    
-   if (shaderType == "vertex") shaderId = glCreateShader(GL_VERTEX_SHADER); 
-   if (shaderType == "tessControl") shaderId = glCreateShader(GL_TESS_CONTROL_SHADER);    
-   if (shaderType == "tessEvaluation") shaderId = glCreateShader(GL_TESS_EVALUATION_SHADER); 
-   if (shaderType == "geometry") shaderId = glCreateShader(GL_GEOMETRY_SHADER); 
-   if (shaderType == "fragment") shaderId = glCreateShader(GL_FRAGMENT_SHADER); 
+   if (strcmp(shaderType, "vertex") == 0) shaderId = glCreateShader(GL_VERTEX_SHADER); 
+   if (strcmp(shaderType, "tessControl") == 0) shaderId = glCreateShader(GL_TESS_CONTROL_SHADER);    
+   if (strcmp(shaderType, "tessEvaluation") == 0) shaderId = glCreateShader(GL_TESS_EVALUATION_SHADER); 
+   if (strcmp(shaderType, "geometry") == 0) shaderId = glCreateShader(GL_GEOMETRY_SHADER); 
+   if (strcmp(shaderType, "fragment") == 0) shaderId = glCreateShader(GL_FRAGMENT_SHADER); 
 
-   glShaderSource(shaderId, 1, (const char**) &shader, NULL); 
+   if (sharedFile == NULL)
+   {
+      glShaderSource(shaderId, 1, (const char**) &shader, NULL); 
+   }
+   else
+   {
+      // #version has to come first, so the file is split after its first line.
+      char* shared = readShader(sharedFile);
+      char* rest = strchr(shader, '\n');
+      rest = rest == NULL ? shader + strlen(shader) : rest + 1;
+      const char* sources[] = { shader, shared, "\n#line 2\n", rest };
+      GLint lengths[] = { (GLint)(rest - shader), -1, -1, -1 };
+      glShaderSource(shaderId, 4, sources, lengths);
+      free(shared);
+   }
    glCompileShader(shaderId); 
+   free(shader);
 
    return shaderId;
 }
-
@@ -1,3 +1,3 @@
 #pragma once
-int setShader(char* shaderType, char* shaderFile);
+int setShader(char* shaderType, char* shaderFile, const char* sharedFile = nullptr);
 
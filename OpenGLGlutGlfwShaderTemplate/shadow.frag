@@ -0,0 +1,6 @@
+#version 430 core
+
+// Nothing to shade, the shadow pass only writes depth.
+void main()
+{
+}
@@ -0,0 +1,33 @@
+#version 430 core
+
+// Depth-only pass that renders the shadow casters into one cascade of ShadowCascades.
+layout(location = 0) in vec3 vertex_position;
+// Per-instance model matrix, only used when instanced is true.
+layout(location = 4) in mat4 instance_model;
+// Index into draws, only used when indirect is true.
+layout(location = 14) in uint draw_index;
+
+uniform mat4 model;
+uniform mat4 lightViewProjection; // Of the cascade being rendered.
+uniform bool instanced;
+uniform bool indirect;
+
+// Same layout as in directional.vert. Only the model matrix matters here.
+struct DrawData
+{
+	mat4 model;
+	mat4 normalMatrix;
+	vec4 tint;
+	ivec4 lights;
+};
+
+layout(std430, binding = 4) readonly buffer Draws
+{
+	DrawData draws[];
+};
+
+void main()
+{
+	mat4 world = indirect ? draws[draw_index].model : (instanced ? instance_model : model);
+	gl_Position = lightViewProjection * world * vec4(vertex_position, 1.0f);
+}
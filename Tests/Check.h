@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cmath>
+#include <iostream>
+
+// Checks that failed so far, across every test. TestMain exits with 1 if there are any.
+inline int& CheckFailures()
+{
+	static int count = 0;
+	return count;
+}
+
+// Both report the failed check with its file and line, and let the test carry on.
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) \
+		{ \
+			std::cerr << __FILE__ << "(" << __LINE__ << "): CHECK(" #condition ") failed." << std::endl; \
+			CheckFailures()++; \
+		} \
+	} while (0)
+
+#define CHECK_NEAR(value, expected, tolerance) \
+	do { \
+		double checkValue = (value), checkExpected = (expected); \
+		if (!(std::fabs(checkValue - checkExpected) <= (tolerance))) \
+		{ \
+			std::cerr << __FILE__ << "(" << __LINE__ << "): CHECK_NEAR(" #value ", " #expected ") failed: " \
+				<< checkValue << " against " << checkExpected << "." << std::endl; \
+			CheckFailures()++; \
+		} \
+	} while (0)
@@ -0,0 +1,67 @@
+#include <memory>
+
+#include "Check.h"
+#include "CommandList.h"
+#include "GLHandle.h"
+#include "MazeShape.h"
+#include "Shape.h"
+
+// Records a MazeShape the way a worker does, without a context: only replay may create or write GL buffers.
+void testCommandList()
+{
+	// Made directly rather than through MeshRegistry, which would buffer them.
+	std::shared_ptr<Shape> cube = std::make_shared<Cube>(1.0f, 1.0f, 1.0f);
+	std::shared_ptr<Shape> prism = std::make_shared<Prism>(6);
+	MazeShape group;
+	for (int i = 0; i < 3; i++)
+		group.addShape(cube, { glm::vec3((float)i, 0, 0), glm::vec3(1, 1, 1), glm::vec3(1, 0, 0), 0 });
+	for (int i = 0; i < 2; i++)
+		group.addShape(prism, { glm::vec3((float)i, 0, -2), glm::vec3(1, 1, 1), glm::vec3(1, 0, 0), 0 });
+	Material material = {};
+	CommandList commands;
+
+	// First record writes the whole instance buffer, and draws each mesh once.
+	group.record(commands, glm::vec3(0, 0, 0), &material);
+	CHECK(commands.drawCount() == 2);
+	CHECK(commands.uploadBytes() == 5 * sizeof(InstanceData));
+	GLsizei instances = 0;
+	for (size_t i = 0; i < commands.drawCount(); i++)
+	{
+		const DrawItem& item = commands.drawItem(i);
+		CHECK(item.material == &material);
+		CHECK(item.model == nullptr);
+		CHECK(item.instanceCount == (item.mesh == cube.get() ? 3 : 2));
+		instances += item.instanceCount;
+	}
+	CHECK(instances == 5);
+
+	// Nothing changed, so nothing is uploaded again.
+	commands.clear();
+	group.record(commands, glm::vec3(0, 0, 0), &material);
+	CHECK(commands.drawCount() == 2);
+	CHECK(commands.uploadBytes() == 0);
+
+	// Moving one entry rewrites just its instance.
+	commands.clear();
+	group.setTransform(1, { glm::vec3(1, 1, 0), glm::vec3(1, 1, 1), glm::vec3(1, 0, 0), 0 });
+	group.record(commands, glm::vec3(0, 0, 0), &material);
+	CHECK(commands.drawCount() == 2);
+	CHECK(commands.uploadBytes() == sizeof(InstanceData));
+
+	// Without instancing every entry is its own draw with its own matrix.
+	commands.clear();
+	group.setInstanced(false);
+	group.record(commands, glm::vec3(0, 0, 0), &material);
+	CHECK(commands.drawCount() == 5);
+	CHECK(commands.uploadBytes() == 0);
+	for (size_t i = 0; i < commands.drawCount(); i++)
+	{
+		CHECK(commands.drawItem(i).model == &group.worldMatrix(i));
+		CHECK(commands.drawItem(i).instanceCount == 0);
+	}
+
+	// Recording never touched GL.
+	CHECK(LiveGLObjects() == 0);
+	CHECK(Shape::BufferCount() == 0);
+	CHECK(Shape::UploadedBytes() == 0);
+}
@@ -0,0 +1,95 @@
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "Check.h"
+#include "LightmapBaker.h"
+
+// Square in the plane y = height, centered on the y axis, facing up.
+static LightmapMesh MakeQuad(float halfSize, float height)
+{
+	LightmapMesh quad;
+	quad.positions = { glm::vec3(-halfSize, height, -halfSize), glm::vec3(halfSize, height, -halfSize),
+		glm::vec3(halfSize, height, halfSize), glm::vec3(-halfSize, height, halfSize) };
+	quad.normals.assign(4, glm::vec3(0.0f, 1.0f, 0.0f));
+	quad.indices = { 0, 2, 1, 0, 3, 2 };
+	return quad;
+}
+
+// Lightmap uv of a point on an unwrapped quad from MakeQuad. The quad is one chart, so uvs are linear across it.
+static glm::vec2 QuadUv(const LightmapMesh& quad, float halfSize, float x, float z)
+{
+	glm::vec2 corners[4];
+	for (unsigned i = 0; i < quad.remap.size(); i++)
+		corners[quad.remap[i]] = quad.lightmapUvs[i];
+	float s = (x + halfSize) / (2.0f * halfSize);
+	float t = (z + halfSize) / (2.0f * halfSize);
+	return corners[0] + (corners[1] - corners[0]) * s + (corners[3] - corners[0]) * t;
+}
+
+static glm::vec3 TexelAt(const LightmapBaker& baker, glm::vec2 uv)
+{
+	int x = (int)(uv.x * baker.size());
+	int y = (int)(uv.y * baker.size());
+	return baker.texels()[(size_t)y * baker.size() + x];
+}
+
+// One floor quad lit by one point light, with a smaller quad between them casting a shadow.
+void testLightmapBaker()
+{
+	const float floorHalf = 2.0f;
+	LightmapMesh floor = MakeQuad(floorHalf, 0.0f);
+	// Centered on x = 1 halfway up to the light, so its shadow covers x from 1.5 to 2.5 on the floor.
+	LightmapMesh occluder = MakeQuad(0.25f, 1.0f);
+	for (glm::vec3& position : occluder.positions)
+		position.x += 1.0f;
+
+	LightmapBaker baker(64);
+	baker.add(&floor);
+	baker.add(&occluder);
+	CHECK(baker.unwrap());
+	CHECK(baker.chartCount() == 2);
+	CHECK(floor.remap.size() == 4);
+	CHECK(floor.lightmapUvs.size() == 4);
+
+	AmbientLight ambient(glm::vec3(1.0f, 1.0f, 1.0f), 0.2f);
+	std::vector<PointLight> points = { PointLight(glm::vec3(0.0f, 2.0f, 0.0f), 10.0f, 1.0f, 4.5f, 75.0f, glm::vec3(1.0f, 0.5f, 0.25f), 1.0f) };
+	baker.bake(ambient, points, {});
+
+	// Straight below the light: full Lambert term at distance 2, with lighting.glsl's falloff.
+	const PointLight& light = points[0];
+	float attenuation = light.quadratic * 4.0f + light.linear * 2.0f + light.constant;
+	float window = 1.0f - powf(2.0f / light.range, 4.0f);
+	glm::vec3 expected = glm::vec3(0.2f) + light.diffuseColor * (window * window / attenuation);
+	glm::vec3 below = TexelAt(baker, QuadUv(floor, floorHalf, 0.0f, 0.0f));
+	// Texel centers sit a little off the exact point.
+	CHECK_NEAR(below.x, expected.x, 0.01);
+	CHECK_NEAR(below.y, expected.y, 0.01);
+	CHECK_NEAR(below.z, expected.z, 0.01);
+
+	// In the occluder's shadow only the ambient light is left, while the mirrored point on the other side is lit.
+	glm::vec3 shadowed = TexelAt(baker, QuadUv(floor, floorHalf, 1.8f, 0.0f));
+	glm::vec3 mirrored = TexelAt(baker, QuadUv(floor, floorHalf, -1.8f, 0.0f));
+	CHECK_NEAR(shadowed.x, 0.2, 1e-4);
+	CHECK_NEAR(shadowed.y, 0.2, 1e-4);
+	CHECK_NEAR(shadowed.z, 0.2, 1e-4);
+	CHECK(mirrored.x > 0.25f);
+	CHECK(mirrored.x < below.x);
+
+	// The occluder's top faces the light, so it is lit too.
+	glm::vec2 occluderCenter = QuadUv(occluder, 0.25f, 0.0f, 0.0f);
+	CHECK(TexelAt(baker, occluderCenter).x > 0.25f);
+
+	// Written as a Radiance file of the baker's size.
+	std::string fileName = "lightmap_test.hdr";
+	CHECK(baker.write(fileName));
+	std::ifstream file(fileName, std::ios::binary);
+	std::string magic;
+	std::getline(file, magic);
+	CHECK(magic == "#?RADIANCE");
+	file.seekg(0, std::ios::end);
+	CHECK((size_t)file.tellg() > (size_t)baker.size() * baker.size() * 4);
+	file.close();
+	std::remove(fileName.c_str());
+}
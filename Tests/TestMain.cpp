@@ -0,0 +1,39 @@
+/** @file TestMain.cpp
+ *
+ *  Runs every test of the engine code that works without a window or a GL context.
+ *  Exits with 1 if any check failed.
+ */
+#include <iostream>
+
+#include "Check.h"
+
+using namespace std;
+
+void testCommandList();
+void testLightmapBaker();
+
+struct Test
+{
+	const char* name;
+	void (*run)();
+};
+
+int main()
+{
+	const Test tests[] = {
+		{ "CommandList", testCommandList },
+		{ "LightmapBaker", testLightmapBaker },
+	};
+	for (const Test& test : tests)
+	{
+		int failures = CheckFailures();
+		test.run();
+		cout << test.name << (CheckFailures() == failures ? " passed." : " FAILED.") << endl;
+	}
+	if (CheckFailures() > 0)
+	{
+		cout << CheckFailures() << " checks failed." << endl;
+		return 1;
+	}
+	return 0;
+}